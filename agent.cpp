@@ -12,12 +12,16 @@
 #include <algorithm>
 #include <cassert>
 #include <numeric>
+#include <limits>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
 #include "globals.h"
 #include "agent.h"
 #include "device.h"
+#include "binaryio.h"
 #include "logging.h"
+#include "profiler.h"
+#include "tournament.h"
 using namespace std;
 
 /**
@@ -45,6 +49,7 @@ void Agent::initializeAll(int number, vector< vector<double> > agentValues)
     name = number;
     penalty = glob.DAILY_EXP_PENALTY;
     endDayGPM = 0.0;
+    deviceMemoryEpoch = 0;
     setAsideTime = 0.0;
     overtime = 0.0;
     agentDeviceTradeMemory =
@@ -52,7 +57,7 @@ void Agent::initializeAll(int number, vector< vector<double> > agentValues)
         (NUM_DEVICE_TYPES, vector< vector <double> >
          (glob.NUM_AGENTS, vector<double>(glob.DEVICE_TRADE_MEMORY_LENGTH, 0.0)));
     deviceBoughtThisRound.clear();
-    tradedDeviceWithThisRound.clear();
+    tradedDeviceWithThisRound.assign(glob.NUM_AGENTS, false);
 
     defineProperties();
 
@@ -107,8 +112,13 @@ void Agent::defineProperties()
     inventSpeed = personalValues[0][11];
     group = personalValues[0][13];
 
+    int *heldRow = glob.agentState.heldRow(name);
+    double *experienceRow = glob.agentState.experienceRow(name);
     for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
         ResProperties newResProp = ResProperties();
+        newResProp.bindState(&heldRow[resId], &experienceRow[resId]);
+        newResProp.setHeld(0);
+        newResProp.setExperience(0.0);
         newResProp.steepness = personalValues[resId][0];
         newResProp.scaling = personalValues[resId][1];
 
@@ -127,8 +137,11 @@ void Agent::defineProperties()
 
     for (int devnum = 0; devnum < NUM_DEVICE_TYPES; devnum++) {
         devProp.push_back(vector<DevProperties>());
+        double *deviceHeldRow = glob.agentState.deviceHeldRow(devnum, name);
         for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
             DevProperties newDevProp = DevProperties();
+            newDevProp.bindState(&deviceHeldRow[resId]);
+            newDevProp.setDeviceHeld(0);
             
             newDevProp.minDeviceEffort = personalValues[resId][5];
             newDevProp.maxDeviceEffort = personalValues[resId][6];
@@ -205,13 +218,13 @@ int Agent::getDevicesMadeToday(int deviceIndex, int deviceType) const
  */
 device_name_t Agent::bestDevice(int resIndex) const
 {
-    if (devProp[INDUSTRY][resIndex].deviceHeld > 0) {
+    if (devProp[INDUSTRY][resIndex].getDeviceHeld() > 0) {
         return INDUSTRY;
-    } else if (devProp[FACTORY][resIndex].deviceHeld > 0) {
+    } else if (devProp[FACTORY][resIndex].getDeviceHeld() > 0) {
         return FACTORY;
-    } else if (devProp[MACHINE][resIndex].deviceHeld > 0) {
+    } else if (devProp[MACHINE][resIndex].getDeviceHeld() > 0) {
         return MACHINE;
-    } else if (devProp[TOOL][resIndex].deviceHeld > 0) {
+    } else if (devProp[TOOL][resIndex].getDeviceHeld() > 0) {
         return TOOL;
     }
     return NO_DEVICE;
@@ -225,17 +238,39 @@ device_name_t Agent::bestDevice(int resIndex) const
 device_name_t Agent::bestDevDevice(device_name_t device, int deviceIndex) const
 {
     if (device == TOOL) {
-        if (devProp[DEVMACHINE][deviceIndex].deviceHeld > 0) {
+        if (devProp[DEVMACHINE][deviceIndex].getDeviceHeld() > 0) {
             return DEVMACHINE;
         }
     } else if (device == MACHINE) {
-        if (devProp[DEVFACTORY][deviceIndex].deviceHeld > 0) {
+        if (devProp[DEVFACTORY][deviceIndex].getDeviceHeld() > 0) {
             return DEVFACTORY;
         }
     }
     return NO_DEVICE;
 }
 
+/**
+ * \return true if a resource with the given utility per minute is the only
+ * one within epsilon of the maximum, when the best of the others has
+ * otherMax.
+ */
+static inline bool onlyCandidate(double value, double otherMax, double epsilon)
+{
+    double threshold = max(value, otherMax) - epsilon;
+    return value >= threshold && otherMax < threshold;
+}
+
+/**
+ * Add value to sum the given number of times, one at a time, so that the
+ * sum comes out to the same bits as when it was added once per unit.
+ */
+static inline void addRepeatedly(double &sum, double value, int times)
+{
+    for (int i = 0; i < times; i++) {
+        sum += value;
+    }
+}
+
 /**
  * Agents extract resources with their given time.
  */
@@ -264,6 +299,9 @@ void Agent::workDay()
      */
     double epsilon = glob.PRODUCTION_EPSILON;
 
+    // The ties within epsilon are broken with this agent's own stream.
+    RandomStream rng(name, glob.currentDay, WORK_STREAM);
+
     // Creates a list of marginal utilities per effort of each resource
     /*
      * Calculate utility per minute based off of agent utility curves, the
@@ -291,7 +329,12 @@ void Agent::workDay()
         resProp[resId].beforeWorkMU = utilCalc(resId);   // For printing out data
 
     }
-    double maxUtilPerEffort = *max_element(valuePerEfforts.begin(), valuePerEfforts.end());
+    /*
+     * The tree keeps the maximum of valuePerEfforts as it changes, and
+     * finds the resources within epsilon of it without looking at the rest.
+     */
+    TournamentTree valueTree(valuePerEfforts);
+    vector<int> nearMaxIndexes;
 
     // If the agent worked overtime on tools, it can't use that time during this day
     /*
@@ -320,68 +363,45 @@ void Agent::workDay()
      * inconsequential -- particularly in longer runs).
      */
     while (time < glob.DAY_LENGTH) {
-        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            /*
-             * All work that would yield utility per effort within epsilon of the
-             * max utility is put into a list. A random resource is chosen from that
-             * list to work on.
-             */
-            if (valuePerEfforts[resId] >= (maxUtilPerEffort - epsilon) && glob.res[resId].inSimulation) {
-                maxUtilIndexes.push_back(resId);
+        /*
+         * All work that would yield utility per effort within epsilon of the
+         * max utility is put into a list, in order of resId. A random resource
+         * is chosen from that list to work on.
+         */
+        valueTree.atLeast(valueTree.maxValue() - epsilon, nearMaxIndexes);
+        for (unsigned i = 0; i < nearMaxIndexes.size(); i++) {
+            if (glob.res[nearMaxIndexes[i]].inSimulation) {
+                maxUtilIndexes.push_back(nearMaxIndexes[i]);
             }
         }
+        nearMaxIndexes.clear();
 
         // A random resource is chosen from that list to work on.
 #ifdef DONT_RANDOMIZE
         workIndex = 0;
 #else
-        workIndex = glob.random_choice(maxUtilIndexes);
+        workIndex = rng.random_choice(maxUtilIndexes);
 #endif
-        device_name_t bestDev = bestDevice(workIndex);
+        time += extractUnit(workIndex, valuePerEfforts);
 
-        /*
-         * Once the resource is decided, the agent calculates the time to
-         * extract the resource based off its experience and the resource-
-         * extracting devices it has
-         */
-        double timeChange;
-        if (bestDev != NO_DEVICE) {
-            timeChange = effortCalc(workIndex) /
-                glob.discoveredDevices[bestDev][workIndex]->deviceFactor;
-            deviceUse(bestDev, workIndex, timeChange);
-        } else {
-            timeChange = effortCalc(workIndex);
-        }
-
-        /*
-         * The time used is incremented by the amount of time the agent used
-         * to extract this resource
-         */
-        time += timeChange;
-
-        /* The agents on the resource (gains a unit and gains experience). */
-        work(workIndex, bestDev);
-        workStatsUpdate(workIndex, bestDev, timeChange);
-
-        /*
-         * The gain per minute that the agent was getting is stored for
-         * reference in device production and trading (the endDayGPM is
-         * treated as the opportunity cost of time).
-         */
-        endDayGPM = valuePerEfforts[workIndex];
-
-        /*
-         * The utility per minute of the extracted resource is recalculated,
-         * and the process begins again.
-         */
-        device_name_t nextBestDevice = bestDevice(workIndex);
-        if (nextBestDevice != NO_DEVICE) {
-            valuePerEfforts[workIndex] = utilPerEffort(workIndex) *
-                glob.discoveredDevices[nextBestDevice][workIndex]->deviceFactor;
-        } else {
-            valuePerEfforts[workIndex] = utilPerEffort(workIndex);
+        if (maxUtilIndexes.size() == 1) {
+            /*
+             * Fast-forward: while the resource stays the only one within
+             * epsilon of the maximum, the next units are extracted in runs
+             * (see extractRun()) without going through the tree.  Each of
+             * them would have drawn its (forced) choice from rng, so the
+             * stream skips as many draws.
+             */
+            valueTree.update(workIndex, -numeric_limits<double>::infinity());
+            double otherMax = valueTree.maxValue();
+            int moreUnits = 0;
+            while (time < glob.DAY_LENGTH &&
+                   onlyCandidate(valuePerEfforts[workIndex], otherMax, epsilon)) {
+                moreUnits += extractRun(workIndex, otherMax, epsilon, valuePerEfforts, time);
+            }
+            rng.discard(moreUnits);
         }
-        maxUtilPerEffort = *max_element(valuePerEfforts.begin(), valuePerEfforts.end());
+        valueTree.update(workIndex, valuePerEfforts[workIndex]);
         maxUtilIndexes.clear();		// empty the vector.
     }
 
@@ -392,6 +412,151 @@ void Agent::workDay()
     workDayEnd();
 }
 
+/**
+ * Extract one unit of a resource: the agent spends the time its
+ * experience and best device call for, gains the unit and the experience,
+ * and the utility per minute of the resource is recalculated.
+ * \param resIndex resource index
+ * \param valuePerEfforts the utility per minute of each resource
+ * \return the time used.
+ */
+double Agent::extractUnit(int resIndex, vector<double> &valuePerEfforts)
+{
+    device_name_t bestDev = bestDevice(resIndex);
+
+    /*
+     * Once the resource is decided, the agent calculates the time to
+     * extract the resource based off its experience and the resource-
+     * extracting devices it has
+     */
+    double timeChange;
+    if (bestDev != NO_DEVICE) {
+        timeChange = effortCalc(resIndex) /
+            glob.discoveredDevices[bestDev][resIndex]->deviceFactor;
+        deviceUse(bestDev, resIndex, timeChange);
+    } else {
+        timeChange = effortCalc(resIndex);
+    }
+
+    /* The agents on the resource (gains a unit and gains experience). */
+    work(resIndex, bestDev);
+    workStatsUpdate(resIndex, bestDev, timeChange);
+
+    /*
+     * The gain per minute that the agent was getting is stored for
+     * reference in device production and trading (the endDayGPM is
+     * treated as the opportunity cost of time).
+     */
+    endDayGPM = valuePerEfforts[resIndex];
+
+    /*
+     * The utility per minute of the extracted resource is recalculated,
+     * and the process begins again.
+     */
+    device_name_t nextBestDevice = bestDevice(resIndex);
+    if (nextBestDevice != NO_DEVICE) {
+        valuePerEfforts[resIndex] = utilPerEffort(resIndex) *
+            glob.discoveredDevices[nextBestDevice][resIndex]->deviceFactor;
+    } else {
+        valuePerEfforts[resIndex] = utilPerEffort(resIndex);
+    }
+    return timeChange;
+}
+
+/**
+ * Extract a run of units of a resource that is the only one within
+ * epsilon of the best utility per minute (see workDay()), as extractUnit()
+ * would one unit at a time.  The run goes on while each unit takes the
+ * same time: it ends at the first unit after which
+ * - the utility per minute of the resource is no longer ahead of otherMax
+ *   by epsilon (found from the list of marginal utilities),
+ * - the experience reaches the next step of the resource efforts,
+ * - the device used runs out of lifetime,
+ * - or the day is over.
+ * The units, the experience, the device minutes and the stats of the run
+ * are then applied at once.  The time, experience and device lifetime are
+ * still added up unit by unit while looking for the end of the run, and
+ * the time sums of the stats are added as many times as there are units,
+ * so that the sums of doubles keep the bits of the one-unit loop.
+ * \param resIndex resource index
+ * \param otherMax the best utility per minute of the other resources
+ * \param epsilon PRODUCTION_EPSILON
+ * \param valuePerEfforts the utility per minute of each resource
+ * \param time the minutes worked so far today, to add the run to
+ * \return the number of units extracted (at least one).
+ */
+int Agent::extractRun(int resIndex, double otherMax, double epsilon,
+                      vector<double> &valuePerEfforts, double &time)
+{
+    ResProperties &resPr = resProp[resIndex];
+    device_name_t bestDev = bestDevice(resIndex);
+    double deviceFactor = 1.0;      // by hand
+    double deviceLeft = 0.0;
+    if (bestDev != NO_DEVICE) {
+        deviceFactor = glob.discoveredDevices[bestDev][resIndex]->deviceFactor;
+        deviceLeft = devProp[bestDev][resIndex].getDeviceHeld();
+    }
+    const vector<double> &marginal = resPr.getMarginalUtilities();
+    const int effortStep = (int) resPr.getExperience();
+    const bool lastStep = (effortStep >= (int) resPr.getResEfforts().size());
+    const double effort = effortCalc(resIndex);
+    const double timeChange = effort / deviceFactor;
+    const double experienceGain = 1.0 / deviceFactor;
+
+    double experience = resPr.getExperience();
+    int held = resPr.getHeld();
+    double value = valuePerEfforts[resIndex];
+    int units = 0;
+    bool more;
+    do {
+        endDayGPM = value;
+        time += timeChange;
+        experience += experienceGain;
+        if (bestDev != NO_DEVICE) {
+            deviceLeft -= timeChange;
+            if (deviceLeft < 0) {
+                deviceLeft = 0;
+            }
+        }
+        held++;
+        units++;
+        double util = (held < (int) marginal.size()) ? marginal[held] : glob.MIN_RES_UTIL;
+        value = (bestDev != NO_DEVICE) ? util / effort * deviceFactor : util / effort;
+        more = time < glob.DAY_LENGTH &&
+            (lastStep || (int) experience == effortStep) &&
+            (bestDev == NO_DEVICE || deviceLeft > 0) &&
+            onlyCandidate(value, otherMax, epsilon);
+    } while (more);
+
+    /* The units, experience and device minutes of the run (see work() and deviceUse()). */
+    resPr.setExperience(experience);
+    resPr.setHeld(held);
+    resPr.idleResource = false;
+
+    /* The stats of the run (see workStatsUpdate()). */
+    resPr.unitsGatheredToday += units;
+    if (bestDev != NO_DEVICE) {
+        devProp[bestDev][resIndex].setDeviceHeld(deviceLeft);
+        unitsGatheredWithDeviceToday[bestDev][resIndex] += units;
+        addRepeatedly(timeSpentGatheringWithDeviceToday[bestDev], timeChange, units);
+        addRepeatedly(timeSpentGatheringWithDeviceTodayByRes[bestDev][resIndex], timeChange, units);
+        addRepeatedly(devProp[bestDev][resIndex].deviceMinutesUsedTotal, timeChange, units);
+    } else {
+        addRepeatedly(timeSpentGatheringWithoutDeviceToday, timeChange, units);
+        addRepeatedly(timeSpentGatheringWithoutDeviceTodayByRes[resIndex], timeChange, units);
+    }
+
+    /* The effort or device may have changed at the end of the run. */
+    device_name_t nextBestDevice = bestDevice(resIndex);
+    if (nextBestDevice != NO_DEVICE) {
+        valuePerEfforts[resIndex] = utilPerEffort(resIndex) *
+            glob.discoveredDevices[nextBestDevice][resIndex]->deviceFactor;
+    } else {
+        valuePerEfforts[resIndex] = utilPerEffort(resIndex);
+    }
+    return units;
+}
+
 /**
  * Removes the amount of time of the device used from the remaining
  * lifetime of the device.
@@ -402,9 +567,9 @@ void Agent::workDay()
 void Agent::deviceUse(device_name_t device, int deviceIndex, double timeChange)
 {
     DevProperties &dev = devProp[device][deviceIndex];
-    dev.deviceHeld -= timeChange;
-    if (dev.deviceHeld < 0) {
-        dev.deviceHeld = 0;
+    dev.setDeviceHeld(dev.getDeviceHeld() - timeChange);
+    if (dev.getDeviceHeld() < 0) {
+        dev.setDeviceHeld(0);
     }
 }
 
@@ -453,9 +618,14 @@ void Agent::toolInvention()
      * holds at least MIN_RES_HELD_FOR_DEVICE_CONSIDERATION units.
      */
     vector<int> heldResources;
+    /*
+     * All random choices of the invention (including those of
+     * deviceInvention) are drawn from this agent's own stream.
+     */
+    RandomStream rng(name, glob.currentDay, INVENT_STREAM);
 
     for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-        experienceCheck.push_back(resProp[resId].experience);
+        experienceCheck.push_back(resProp[resId].getExperience());
         if ( (resHeld(resId) > glob.MIN_RES_HELD_FOR_DEVICE_CONSIDERATION) && glob.res[resId].inSimulation) {
             heldResources.push_back(resId);
         }
@@ -498,10 +668,10 @@ void Agent::toolInvention()
 #ifdef DONT_RANDOMIZE
             int considered = 0;
 #else
-            int considered = glob.random_choice(heldResources);
+            int considered = rng.random_choice(heldResources);
 #endif
             consideredResources.push_back(considered);
-            consideredResourcesExp.push_back(resProp[considered].experience);
+            consideredResourcesExp.push_back(resProp[considered].getExperience());
             heldResources.erase( find(heldResources.begin(), heldResources.end(), considered) );
         }
         sort(consideredResources.begin(), consideredResources.end());
@@ -539,7 +709,7 @@ void Agent::toolInvention()
 #else
         double probability = glob.TOOL_PROBABILITY_FACTOR * sumExp * inventSpeed;
 #endif
-        double ran = glob.random_01();
+        double ran = rng.random_01();
         if ( ran < probability ) {
             /* 
              * If the agent successfully invents a tool, one of the
@@ -550,7 +720,7 @@ void Agent::toolInvention()
 #ifdef DONT_RANDOMIZE
             int toolUse = 0;
 #else
-            int toolUse = glob.random_choice(noTool);
+            int toolUse = rng.random_choice(noTool);
 #endif
             consideredResources.erase( find(consideredResources.begin(), consideredResources.end(), toolUse) );
 
@@ -560,13 +730,16 @@ void Agent::toolInvention()
              * but all agents except the inventor are given zero experience,
              * so they cannot build this tool
              */
+            vector<Device *> users;     // the devices the replaced tool is a component of
             if (glob.discoveredDevices[TOOL][toolUse] != NULL) {
                 LOG(4) << "Creating new " << device_names[TOOL]
                        << " to replace existing tool "
                        << toolUse << " for which agentsKnown is 0.\n";
+                users = glob.discoveredDevices[TOOL][toolUse]->usedIn;
                 delete glob.discoveredDevices[TOOL][toolUse];
             }
             glob.discoveredDevices[TOOL][toolUse] = new Tool(consideredResources, toolUse);
+            glob.discoveredDevices[TOOL][toolUse]->usedIn = users;
             for (int agId = 0; agId < glob.NUM_AGENTS; agId++) {
                 glob.agent[agId]->devProp[TOOL][toolUse].setDeviceExperience(0.0);
                 glob.agent[agId]->devProp[TOOL][toolUse].idleDevice = true;
@@ -587,10 +760,10 @@ void Agent::toolInvention()
          * try to invent a device-making-machine.
          */
         LOG(4) << "No tools to consider so what about MACHINES or DEVMACHINES?";
-        if (glob.random_int_inclusive(0, 1) == 0) {
-            deviceInvention(MACHINE, TOOL);
+        if (rng.random_int_inclusive(0, 1) == 0) {
+            deviceInvention(MACHINE, TOOL, rng);
         } else {
-            deviceInvention(DEVMACHINE, TOOL);
+            deviceInvention(DEVMACHINE, TOOL, rng);
         }
     }
 }
@@ -600,8 +773,9 @@ void Agent::toolInvention()
  * agents have a chance to invent a device
  * \param device the type of the device being invented
  * \param componentType the type of the component device
+ * \param rng the inventing agent's random stream for today
  */
-void Agent::deviceInvention(device_name_t device, device_name_t componentType)
+void Agent::deviceInvention(device_name_t device, device_name_t componentType, RandomStream &rng)
 {
     /*
      * When inventing a higher-order device, agents will consider
@@ -717,7 +891,7 @@ void Agent::deviceInvention(device_name_t device, device_name_t componentType)
              * of known devices.
              */
             if (! myKnownDevices.empty()) {
-                int considered = glob.random_choice(myKnownDevices);
+                int considered = rng.random_choice(myKnownDevices);
                 consideredDevices.push_back(considered);
                 consideredDevicesExp.push_back(devProp[componentType][considered].getDeviceExperience());
                 myKnownDevices.erase( find(myKnownDevices.begin(), myKnownDevices.end(), considered) );
@@ -729,7 +903,7 @@ void Agent::deviceInvention(device_name_t device, device_name_t componentType)
                  * known by the agent.
                  */
             } else {
-                int considered = glob.random_choice(knownDevices);
+                int considered = rng.random_choice(knownDevices);
                 consideredDevices.push_back(considered);
                 consideredDevicesExp.push_back(devProp[componentType][considered].getDeviceExperience());
                 knownDevices.erase( find(knownDevices.begin(), knownDevices.end(), considered) );
@@ -759,7 +933,7 @@ void Agent::deviceInvention(device_name_t device, device_name_t componentType)
     if (! noDevice.empty()) {
         double sumExp = accumulate(consideredDevicesExp.begin(),
                                    consideredDevicesExp.end(), 0.0);
-        if (glob.random_01() < (glob.DEVICE_PROBABILITY_FACTOR * sumExp * inventSpeed)) {
+        if (rng.random_01() < (glob.DEVICE_PROBABILITY_FACTOR * sumExp * inventSpeed)) {
             /*
              * If the agent successfully invents a device, one of the
              * considered resources without a device is randomly selected
@@ -767,16 +941,18 @@ void Agent::deviceInvention(device_name_t device, device_name_t componentType)
              * for the selected resource become the components of the new
              * device.
              */
-            deviceUse = glob.random_choice(noDevice);
+            deviceUse = rng.random_choice(noDevice);
             /*
              * All agents find out about the existence of the new device,
              * but they are given zero experience, so they cannot build
              * it.
              */
+            vector<Device *> users;     // the devices the replaced device is a component of
             if (glob.discoveredDevices[device][deviceUse] != NULL) {
                 LOG(4) << "Creating new " << device_names[device]
                        << " to replace existing device "
                        << deviceUse << " for which agentsKnown is 0.\n";
+                users = glob.discoveredDevices[device][deviceUse]->usedIn;
                 delete glob.discoveredDevices[device][deviceUse];
             }
             switch (device) {
@@ -804,6 +980,7 @@ void Agent::deviceInvention(device_name_t device, device_name_t componentType)
                 cerr << "BAD device type in device variable at " << __FILE__ << ":" << __LINE__ << endl;
                 break;
             }
+            glob.discoveredDevices[device][deviceUse]->usedIn = users;
             for (int agId = 0; agId < glob.NUM_AGENTS; agId++) {
                 glob.agent[agId]->devProp[device][deviceUse].setDeviceExperience(0.0);
                 glob.agent[agId]->devProp[device][deviceUse].idleDevice = true;
@@ -830,11 +1007,11 @@ void Agent::deviceInvention(device_name_t device, device_name_t componentType)
          * on to attempt to invent the device of the next higher order.
     	 */
         if (device == MACHINE) {
-            deviceInvention(FACTORY, MACHINE);
+            deviceInvention(FACTORY, MACHINE, rng);
         } else if (device == FACTORY) {
-            deviceInvention(INDUSTRY, FACTORY);
+            deviceInvention(INDUSTRY, FACTORY, rng);
         } else if (device == DEVMACHINE) {
-            deviceInvention(DEVFACTORY, DEVMACHINE);
+            deviceInvention(DEVFACTORY, DEVMACHINE, rng);
         }
     }
 }
@@ -889,7 +1066,7 @@ void Agent::makeDevice(int deviceIndex, device_name_t device)
      * devicesRecentlyMade is tracked to help agents decide whether or not
      * they want to make device-making devices.
      */
-    devProp[device][deviceIndex].devicesRecentlyMade[0]++;
+    devProp[device][deviceIndex].devicesRecentlyMade.addToNewest(1);
     /* Relevant device statistics get updated. */
     deviceStatsUpdate(deviceIndex, device, bestDevDev, timeUse);
     LOG(4) << "I'm agent " << name << ", I made a " << device_names[device] <<
@@ -909,9 +1086,9 @@ void Agent::work(int resIndex, device_name_t bestDevice)
 {
     ResProperties &resPr = resProp[resIndex];
     if (bestDevice != NO_DEVICE) {
-        resPr.experience += 1.0 / glob.discoveredDevices[bestDevice][resIndex]->deviceFactor;
+        resPr.setExperience(resPr.getExperience() + 1.0 / glob.discoveredDevices[bestDevice][resIndex]->deviceFactor);
     } else {
-        resPr.experience++;
+        resPr.setExperience(resPr.getExperience() + 1);
     }
     resPr.setHeld(resPr.getHeld() + 1);
     /*
@@ -1001,16 +1178,16 @@ void Agent::workDayEnd()
          * penalty experience.
          */
         if (resPr.idleResource) {
-            resPr.experience -= penalty;
+            resPr.setExperience(resPr.getExperience() - penalty);
             /* Agent resource experience cannot drop below 0. */
-            if (resPr.experience < 0) {
-                resPr.experience = 0.0;
+            if (resPr.getExperience() < 0) {
+                resPr.setExperience(0.0);
             }
         }
         resPr.idleResource = true;
         /* Agent resource experience cannot exceed MAX_RES_EXPERIENCE. */
-        if (resPr.experience > glob.MAX_RES_EXPERIENCE) {
-            resPr.experience = glob.MAX_RES_EXPERIENCE;
+        if (resPr.getExperience() > glob.MAX_RES_EXPERIENCE) {
+            resPr.setExperience(glob.MAX_RES_EXPERIENCE);
         }
         /* Used for printing some data */
         resPr.unitsGatheredEndWork = resPr.unitsGatheredToday;
@@ -1042,7 +1219,7 @@ void Agent::endDayChecks()
              * experience in that device can not drop below MIN_HELD_DEVICE_EXPERIENCE.
              */
             if (thisDevice.getDeviceExperience() < glob.MIN_HELD_DEVICE_EXPERIENCE &&
-                thisDevice.deviceHeld > 0) {
+                thisDevice.getDeviceHeld() > 0) {
                 thisDevice.setDeviceExperience(glob.MIN_HELD_DEVICE_EXPERIENCE);
             }
             assert( (thisDevice.getDeviceExperience() <= glob.MAX_DEVICE_EXPERIENCE) ||
@@ -1073,6 +1250,7 @@ void Agent::endDayChecks()
  */
 void Agent::decay()
 {
+    RandomStream rng(name, glob.currentDay, DECAY_STREAM);
     for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
     	/*
     	 * Each unit of each resource has a 1.0/self.resProp[resId].averageLifetime
@@ -1084,7 +1262,7 @@ void Agent::decay()
             resProp[resId].setHeld(resProp[resId].getHeld() - resProp[resId].getHeld()*0.25);
 #else
             resProp[resId].setHeld(resProp[resId].getHeld() -
-                                    glob.random_binomial(resProp[resId].getHeld(),
+                                    rng.random_binomial(resProp[resId].getHeld(),
                                             1.0 / resProp[resId].averageLifetime));
 #endif
         }
@@ -1095,14 +1273,14 @@ void Agent::decay()
          */
         for (int dev = TOOL; dev <= DEVFACTORY; dev++) {
             DevProperties &thisDevice = devProp[dev][resId];
-            double oldDeviceHeld = thisDevice.deviceHeld;
-            if (thisDevice.deviceHeld > glob.DAILY_DEVICE_DECAY) {
-                thisDevice.deviceHeld -= glob.DAILY_DEVICE_DECAY *
-                    (thisDevice.deviceHeld / glob.discoveredDevices[dev][resId]->lifetime);
-            } else if (thisDevice.deviceHeld <= glob.DAILY_DEVICE_DECAY) {
-                thisDevice.deviceHeld = 0;
+            double oldDeviceHeld = thisDevice.getDeviceHeld();
+            if (thisDevice.getDeviceHeld() > glob.DAILY_DEVICE_DECAY) {
+                thisDevice.setDeviceHeld(thisDevice.getDeviceHeld() - glob.DAILY_DEVICE_DECAY *
+                    (thisDevice.getDeviceHeld() / glob.discoveredDevices[dev][resId]->lifetime));
+            } else if (thisDevice.getDeviceHeld() <= glob.DAILY_DEVICE_DECAY) {
+                thisDevice.setDeviceHeld(0);
             }
-            thisDevice.deviceMinutesDecayTotal += oldDeviceHeld - thisDevice.deviceHeld;
+            thisDevice.deviceMinutesDecayTotal += oldDeviceHeld - thisDevice.getDeviceHeld();
         }
     }
 }
@@ -1132,6 +1310,7 @@ void Agent::updateDeviceComponentExperience()
                     comp < glob.discoveredDevices[type][resId]->components.end(); comp++) {
                     if (devProp[compType][*comp].getDeviceExperience() < 1) {
                         devProp[compType][*comp].setDeviceExperience(1.0);
+                        forgetDeviceMemoryOfDevice(compType, *comp);
                     }
                 }
             }
@@ -1150,7 +1329,7 @@ double Agent::deviceHeldForRes(int resIndex) const
     device_name_t typeToCheck = TOOL;
     double minutesHeld = 0.0;
     while (glob.discoveredDevices[typeToCheck][resIndex] != NULL) {
-        minutesHeld += devProp[typeToCheck][resIndex].deviceHeld;
+        minutesHeld += devProp[typeToCheck][resIndex].getDeviceHeld();
         typeToCheck = glob.discoveredDevices[typeToCheck][resIndex]->componentOf;
         if (typeToCheck == NO_DEVICE) {
             break;
@@ -1210,16 +1389,22 @@ double Agent::buyerDeviceValue(int resIndex, device_name_t device)
  */
 vector<int> Agent::preferredDeviceTraders(device_name_t device)
 {
-    vector<double> tradeMemoriesSort;
+    /*
+     * The agents with a positive sum, sorted on (- sum, agId): the largest
+     * sum first, and the lowest agId first among equal sums.
+     */
+    vector<pair<double, int> > tradeMemoriesSort;
     for (int agId = 0; agId < glob.NUM_AGENTS; agId++) {
         double sum = accumulate(agentDeviceTradeMemory[device][agId].begin(),
                                 agentDeviceTradeMemory[device][agId].end(), 0.0);
-        tradeMemoriesSort.push_back(sum);
+        if (sum > 0) {
+            tradeMemoriesSort.push_back(make_pair(- sum, agId));
+        }
     }
+    sort(tradeMemoriesSort.begin(), tradeMemoriesSort.end());
     vector<int> preference;
-    while ( *max_element(tradeMemoriesSort.begin(), tradeMemoriesSort.end()) > 0) {
-        preference.push_back(max_element(tradeMemoriesSort.begin(), tradeMemoriesSort.end()) - tradeMemoriesSort.begin());
-        tradeMemoriesSort[max_element(tradeMemoriesSort.begin(), tradeMemoriesSort.end()) - tradeMemoriesSort.begin()] = 0.0;
+    for (unsigned i = 0; i < tradeMemoriesSort.size(); i++) {
+        preference.push_back(tradeMemoriesSort[i].second);
     }
     return preference;
 }
@@ -1245,6 +1430,7 @@ void Agent::getBackRes(int toolIndex, device_name_t bestDevDevice)
          comp < glob.discoveredDevices[TOOL][toolIndex]->components.end(); comp++) {
         resProp[*comp].setHeld(resProp[*comp].getHeld() + 1);
         resProp[*comp].resSetAside--;
+        forgetDeviceMemoryOfRes(*comp);
     }
 }
 
@@ -1275,8 +1461,9 @@ void Agent::getBackDeviceComponents(device_name_t device, int deviceIndex)
              comp < glob.discoveredDevices[device][deviceIndex]->components.end(); comp++) {
             DevProperties &thisComponent = devProp[compType][*comp];
             if (thisComponent.devicesSetAside > 0) {
-                thisComponent.deviceHeld += glob.discoveredDevices[compType][*comp]->lifetime;
+                thisComponent.setDeviceHeld(thisComponent.getDeviceHeld() + glob.discoveredDevices[compType][*comp]->lifetime);
                 thisComponent.devicesSetAside--;
+                forgetDeviceMemoryOfDevice(compType, *comp);
             } else if (thisComponent.devicesToMake > 0) {
                 getBackDeviceComponents(compType, *comp);
             }
@@ -1305,6 +1492,7 @@ void Agent::setAsideRes(int toolIndex, device_name_t bestDevDevice)
          comp < glob.discoveredDevices[TOOL][toolIndex]->components.end(); comp++) {
         resProp[*comp].setHeld(resProp[*comp].getHeld() - 1);
         resProp[*comp].resSetAside++;
+        forgetDeviceMemoryOfRes(*comp);
     }
 }
 
@@ -1332,9 +1520,10 @@ void Agent::setAsideDeviceComponents(device_name_t device, int deviceIndex)
         device_name_t compType = glob.discoveredDevices[device][deviceIndex]->componentType;
         for (vector<int>::iterator comp = glob.discoveredDevices[device][deviceIndex]->components.begin();
              comp < glob.discoveredDevices[device][deviceIndex]->components.end(); comp++) {
-            if (devProp[compType][*comp].deviceHeld >= glob.discoveredDevices[compType][*comp]->lifetime) {
-                devProp[compType][*comp].deviceHeld -= glob.discoveredDevices[compType][*comp]->lifetime;
+            if (devProp[compType][*comp].getDeviceHeld() >= glob.discoveredDevices[compType][*comp]->lifetime) {
+                devProp[compType][*comp].setDeviceHeld(devProp[compType][*comp].getDeviceHeld() - glob.discoveredDevices[compType][*comp]->lifetime);
                 devProp[compType][*comp].devicesSetAside++;
+                forgetDeviceMemoryOfDevice(compType, *comp);
             } else {
                 setAsideDeviceComponents(compType, *comp);
             }
@@ -1363,23 +1552,18 @@ pair<bool, double> Agent::canBuy(Device &device)
      */
     // seems like this is the only thing that takes a Device object as
     // a parameter...  should we fix this?
-    int bought = 0;
+    /*
+     * If the remembered price is positive, the agent purchased the
+     * device (if the price was negative, the agent made the device for
+     * itself or sold the device).  The memory keeps both counts.
+     */
+    const RingMemory<double> &prices = devProp[device.type][device.use].devicePrices;
+    int bought = prices.numPositive();
     /*
      * paid is the total amount (in utility) paid by the agent for the
      * purchased devices.
      */
-    double paid = 0.0;
-    for (int devTrade = 0; devTrade < glob.DEVICE_TRADE_MEMORY_LENGTH; devTrade++) {
-    	/*
-    	 * If the remembered price is positive, the agent purchased the
-         * device (if the price was negative, the agent made the device for
-         * itself or sold the device).
-    	 */
-        if (devProp[device.type][device.use].devicePrices[devTrade] > 0) {
-            bought++;
-            paid += devProp[device.type][device.use].devicePrices[devTrade];
-        }
-    }
+    double paid = prices.positiveTotal();
     double averagePrice;
     bool buy;
     if (bought >= glob.DEVICE_TRADE_MEMORY_LENGTH / 2) {
@@ -1405,9 +1589,10 @@ pair<bool, double> Agent::canBuy(Device &device)
  */
 void Agent::buysDevice(int deviceIndex, device_name_t device)
 {
-    resetDeviceGainAndCostMemory();
+    refreshDeviceGainAndCostMemory();
     if (devProp[device][deviceIndex].getDeviceExperience() < glob.MIN_HELD_DEVICE_EXPERIENCE) {
         devProp[device][deviceIndex].setDeviceExperience(glob.MIN_HELD_DEVICE_EXPERIENCE);
+        forgetDeviceMemoryOfDevice(device, deviceIndex);
     }
     updateDeviceComponentExperience();
     /*
@@ -1423,7 +1608,8 @@ void Agent::buysDevice(int deviceIndex, device_name_t device)
     	 * If the agent had not committed to make this device, then it
          * immediately gains the lifetime of the device into its holdings.
     	 */
-        devProp[device][deviceIndex].deviceHeld += glob.discoveredDevices[device][deviceIndex]->lifetime;
+        devProp[device][deviceIndex].setDeviceHeld(devProp[device][deviceIndex].getDeviceHeld() + glob.discoveredDevices[device][deviceIndex]->lifetime);
+        forgetDeviceMemoryOfDevice(device, deviceIndex);
     }
 }
 
@@ -1435,20 +1621,21 @@ void Agent::buysDevice(int deviceIndex, device_name_t device)
  */
 void Agent::sellsDevice(int deviceIndex, device_name_t device)
 {
-    resetDeviceGainAndCostMemory();
+    refreshDeviceGainAndCostMemory();
     /*
      * If the agent doesn't already hold enough minutes of the device to
      * give to the other agent, it must commit to making the device by
      * setting aside the device components.
      */
-    if (devProp[device][deviceIndex].deviceHeld < glob.discoveredDevices[device][deviceIndex]->lifetime) {
+    if (devProp[device][deviceIndex].getDeviceHeld() < glob.discoveredDevices[device][deviceIndex]->lifetime) {
         setAsideDeviceComponents(device, deviceIndex);
     } else {
     	/*
     	 * If the agent holds enough minutes of the device, it can immediately
          * forfeit those minutes and move on.
     	 */
-        devProp[device][deviceIndex].deviceHeld -= glob.discoveredDevices[device][deviceIndex]->lifetime;
+        devProp[device][deviceIndex].setDeviceHeld(devProp[device][deviceIndex].getDeviceHeld() - glob.discoveredDevices[device][deviceIndex]->lifetime);
+        forgetDeviceMemoryOfDevice(device, deviceIndex);
     }
 }
 
@@ -1485,33 +1672,6 @@ double Agent::gainOfResourceBundle(vector<int> &resourceBundle) const
     return gain;
 }
 
-/**
- * Use map to memoize the used sum of certain indices of marginalUtilities.
- */
-double Agent::myAccumulate(int resIndex, int change) const
-{
-    const vector<double> &margUtility = resProp[resIndex].marginalUtilities;
-    int myHeld = resHeld(resIndex);
-    pair<int, int> temp = make_pair(myHeld, change);
-    double result;
-    if (change > 0) {
-        if (glob.memoMUs[group].count(temp) != 0) {
-            result = glob.memoMUs[group][temp];
-        } else {
-            result = accumulate(margUtility.begin() + myHeld, margUtility.begin() + myHeld + change, 0.0);
-            glob.memoMUs[group][temp] = result;
-        }
-    } else if (change < 0) {
-        if (glob.memoMUs[group].count(temp) != 0) {
-            result = glob.memoMUs[group][temp];
-        } else {
-            result = accumulate(margUtility.begin() + myHeld + change, margUtility.begin() + myHeld, 0.0);
-            glob.memoMUs[group][temp] = result;
-        }
-    }
-    return result;
-}
-
 /**
  * Calculates the sums of the marginal utilities of the units of a
  * given resource in a given range(essentially the integral of the MU
@@ -1521,6 +1681,7 @@ double Agent::myAccumulate(int resIndex, int change) const
  */
 double Agent::barterUtility(int resIndex, int change) const
 {
+    prof.count(BARTER_UTILITY_COUNT);
     if (resHeld(resIndex) < 0) {
         /*
          * NOTE: in the python version if myHeld is negative,
@@ -1530,18 +1691,18 @@ double Agent::barterUtility(int resIndex, int change) const
          */
         return 0.0;
     }
-    const vector<double> &margUtility = resProp[resIndex].marginalUtilities;
-    int margUtilLen = margUtility.size();
+    const ResProperties &prop = resProp[resIndex];
+    int margUtilLen = prop.getMarginalUtilities().size();
     int myHeld = resHeld(resIndex);
     double result = 0.0;
     if (change > 0) {
         if (myHeld + change < margUtilLen) {
-            result = myAccumulate(resIndex, change);
+            result = prop.utilityOfUnits(myHeld, myHeld + change);
         } else {
             if (myHeld >= margUtilLen) {
                 return glob.MIN_RES_UTIL * (myHeld + change - margUtilLen);
             }
-            result = accumulate(margUtility.begin() + myHeld, margUtility.begin() + margUtilLen, 0.0) + glob.MIN_RES_UTIL * (myHeld + change - margUtilLen);
+            result = prop.utilityOfUnits(myHeld, margUtilLen) + glob.MIN_RES_UTIL * (myHeld + change - margUtilLen);
         }
     } else if (change < 0) {
         if (myHeld + change < 0) {
@@ -1554,12 +1715,12 @@ double Agent::barterUtility(int resIndex, int change) const
             return 0.0;
         }
         if (myHeld < margUtilLen) {
-            result = myAccumulate(resIndex, change);
+            result = prop.utilityOfUnits(myHeld + change, myHeld);
         } else {
             if (myHeld + change >= margUtilLen) {
                 return glob.MIN_RES_UTIL * (myHeld - margUtilLen);
             }
-            result = accumulate(margUtility.begin() + myHeld + change, margUtility.begin() + margUtilLen, 0.0) + glob.MIN_RES_UTIL * (myHeld - margUtilLen);
+            result = prop.utilityOfUnits(myHeld + change, margUtilLen) + glob.MIN_RES_UTIL * (myHeld - margUtilLen);
         }
     }
     return result;
@@ -1575,7 +1736,7 @@ MaxInfo Agent::calcMaxDeviceGainAndIndex(device_name_t deviceType)
 
     MaxInfo maxIF;
     vector<Device *> &consideredDevice = glob.discoveredDevices[deviceType];
-    resetDeviceGainAndCostMemory();
+    refreshDeviceGainAndCostMemory();
     /*
      * deviceBenefits is a list of utility gains of obtaining the device of
      * the given device type for the resource with the corresponding resId.
@@ -1653,14 +1814,12 @@ void Agent::personalDevices(device_name_t device)
      * it makes devices.
      */
     while (maxGain > 0) {
-        devProp[device][maxIdxOffset].devicePrices.pop_back();
-        // NOTE: this is very inefficient!  We may want to make this thing a dlist or
-        // list or deque.
         /*
          * Because the agent is making this device for itself, it remembers
          * the price as a negative value .
          */
-        devProp[device][maxIdxOffset].devicePrices.insert(devProp[device][maxIdxOffset].devicePrices.begin(), - costOfMax);
+        devProp[device][maxIdxOffset].devicePrices.remember(- costOfMax);
+        forgetDeviceMemoryOfDevice(device, maxIdxOffset);
 
         /* payment is the cost of the device excluding the time cost. */
         double payment = costOfMax - 
@@ -1674,7 +1833,8 @@ void Agent::personalDevices(device_name_t device)
          */
         setAsideDeviceComponents(device, maxIdxOffset);
         /* The agent immediately gains the lifetime of the device. */
-        devProp[device][maxIdxOffset].deviceHeld += consideredDevice[maxIdxOffset]->lifetime;
+        devProp[device][maxIdxOffset].setDeviceHeld(devProp[device][maxIdxOffset].getDeviceHeld() + consideredDevice[maxIdxOffset]->lifetime);
+        forgetDeviceMemoryOfDevice(device, maxIdxOffset);
 
         LOG(4) << "Agent " << name <<  " wants to make a " << device_names[device] << 
             " for " << maxIdxOffset << " (maxGain, costOfMax, benefitOfMax) = (" <<
@@ -1721,9 +1881,7 @@ void Agent::deviceProduction()
         device_name_t device = deviceList[idx];
         vector<DevProperties> &thisDev = devProp[device];
         for (int resNum = 0; resNum < glob.NUM_RESOURCES; resNum++) {
-            thisDev[resNum].devicesRecentlyMade.pop_back();
-            // TODO: this is not efficient for vectors.  Perhap use a deque?
-            thisDev[resNum].devicesRecentlyMade.insert(thisDev[resNum].devicesRecentlyMade.begin(), 0);
+            thisDev[resNum].devicesRecentlyMade.remember(0);
         }
     }
     /* Then, the agent makes all the devices it has committed to make. */
@@ -1756,7 +1914,7 @@ void Agent::calcUtilityToday()
  */
 void Agent::newDeviceTrade(device_name_t device)
 {
-    tradedDeviceWithThisRound.clear();
+    tradedDeviceWithThisRound.assign(glob.NUM_AGENTS, false);
     resetDeviceGainAndCostMemory();
     for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
         if (*max_element(agentDeviceTradeMemory[device][aId].begin(), agentDeviceTradeMemory[device][aId].end()) > 0) {
@@ -1769,7 +1927,11 @@ void Agent::newDeviceTrade(device_name_t device)
 /**
  * Any time an agent's holdings of resources or devices changes, the
  * memory that it has of the values of devices is no longer correct, so
- * these values must be reset.
+ * these values must be reset.  This forgets all of them, for the start of
+ * a day's or a device type's trading, after the changes (work, resource
+ * trades, endDayGPM) that are not reported by forgetDeviceMemoryOfRes()
+ * and forgetDeviceMemoryOfDevice(); within the trading,
+ * refreshDeviceGainAndCostMemory() forgets only what has changed.
  */
 void Agent::resetDeviceGainAndCostMemory()
 {
@@ -1788,6 +1950,129 @@ void Agent::resetDeviceGainAndCostMemory()
 }
 
 
+/**
+ * Has the same effect as resetDeviceGainAndCostMemory(), provided that
+ * every change since the last reset to what the memories are computed from
+ * has been reported: the memories that nothing has changed under would be
+ * computed again to the same values, so they are kept.
+ *
+ * A memory computed or used since the last refresh, whose inputs have
+ * changed since, is stale (it is still used, as before, until this
+ * refresh, which drops it).  A memory not used since the last refresh is
+ * dropped as soon as its inputs change, because its first use after a
+ * reset would have computed it from the changed inputs.
+ */
+void Agent::refreshDeviceGainAndCostMemory()
+{
+    deviceMemoryEpoch++;
+}
+
+
+/**
+ * \return whether the agent has a valid memory of the given value of a
+ * device, and marks the memory as used in this epoch.
+ */
+bool Agent::recallsDeviceMemory(device_name_t type, int use, device_memory_t memory)
+{
+    DevProperties &thisDevProp = devProp[type][use];
+    bool &valid = thisDevProp.memoryValid(memory);
+    if (valid && thisDevProp.memoryStale[memory] &&
+        thisDevProp.memoryEpoch[memory] != deviceMemoryEpoch) {
+        valid = false;
+    }
+    if (valid) {
+        thisDevProp.memoryEpoch[memory] = deviceMemoryEpoch;
+    }
+    return valid;
+}
+
+
+/**
+ * Marks the given value of a device, just computed, as remembered.
+ */
+void Agent::storesDeviceMemory(device_name_t type, int use, device_memory_t memory)
+{
+    DevProperties &thisDevProp = devProp[type][use];
+    thisDevProp.memoryValid(memory) = true;
+    thisDevProp.memoryEpoch[memory] = deviceMemoryEpoch;
+    thisDevProp.memoryStale[memory] = false;
+}
+
+
+/**
+ * Something the given memory is computed from has changed.
+ */
+void Agent::forgetDeviceMemory(device_name_t type, int use, device_memory_t memory)
+{
+    DevProperties &thisDevProp = devProp[type][use];
+    bool &valid = thisDevProp.memoryValid(memory);
+    if (! valid) {
+        return;
+    }
+    if (thisDevProp.memoryEpoch[memory] == deviceMemoryEpoch) {
+        thisDevProp.memoryStale[memory] = true;
+    } else {
+        valid = false;
+    }
+}
+
+
+/**
+ * Something the cost or worst case construction of a device is computed
+ * from has changed, so it has changed for every device that the device is
+ * a component of too.
+ */
+void Agent::forgetDeviceCostMemory(device_name_t type, int use)
+{
+    Device *device = glob.discoveredDevices[type][use];
+    if (device == NULL) {
+        return;
+    }
+    forgetDeviceMemory(type, use, COST_MEMORY);
+    forgetDeviceMemory(type, use, WORST_CASE_MEMORY);
+    for (int i = 0; i < (int) device->usedIn.size(); i++) {
+        forgetDeviceCostMemory(device->usedIn[i]->type, device->usedIn[i]->use);
+    }
+}
+
+
+/**
+ * Reports a change in the units held or the experience of a resource:
+ * the gains of the devices for the resource, and the costs of the tools
+ * made from it, are no longer correct.
+ */
+void Agent::forgetDeviceMemoryOfRes(int resId)
+{
+    for (int dev = TOOL; dev <= DEVFACTORY; dev++) {
+        forgetDeviceMemory((device_name_t) dev, resId, GAIN_MEMORY);
+    }
+    const vector<Device *> &tools = glob.res[resId].usedIn;
+    for (int i = 0; i < (int) tools.size(); i++) {
+        forgetDeviceCostMemory(TOOL, tools[i]->use);
+    }
+}
+
+
+/**
+ * Reports a change in the minutes held, the experience or the remembered
+ * prices of a device: its cost and worst case construction (and those of
+ * the devices it is a component of, or is the device-making device of) and
+ * the gains of the devices for the same resource are no longer correct.
+ */
+void Agent::forgetDeviceMemoryOfDevice(device_name_t type, int use)
+{
+    forgetDeviceCostMemory(type, use);
+    if (type == DEVMACHINE) {
+        forgetDeviceCostMemory(TOOL, use);
+    } else if (type == DEVFACTORY) {
+        forgetDeviceCostMemory(MACHINE, use);
+    }
+    for (int dev = TOOL; dev <= DEVFACTORY; dev++) {
+        forgetDeviceMemory((device_name_t) dev, use, GAIN_MEMORY);
+    }
+}
+
+
 /**
  * Agents keep track of certain day-to-day statistics, and at the end
  * of each day, these statistics must be reset to 0.
@@ -1873,6 +2158,9 @@ int Agent::calcMaxHeld()
  */
 void Agent::logAgentData()
 {
+    if (! LOG_ENABLED(5)) {
+        return;     // do not format the values of each resource and device for nothing
+    }
     LOG(5) << "**************** AGENT " << name << " ******************** ";
     LOG(5) << " ---- scalars --- ";
     LOG(5) << "penalty " << penalty;
@@ -1890,7 +2178,7 @@ void Agent::logAgentData()
         char ostr[128];
         sprintf(ostr, "%2d\t%8.4f\t%3d\t%d\t%8.4f\t%4d\t%4d", i,
                 resProp[i].endDayUtilities, resProp[i].getHeld(),
-                resProp[i].idleResource, resProp[i].experience, resProp[i].resSetAside,
+                resProp[i].idleResource, resProp[i].getExperience(), resProp[i].resSetAside,
                 resProp[i].unitsGatheredToday);
         LOG(5) << ostr;
     }
@@ -1901,7 +2189,7 @@ void Agent::logAgentData()
             LOG(5) << " device " << i << ", type " << type;
             char ostr[128];
             sprintf(ostr, "%8.4f\t%8.4f\t%d\t%d\t%d\t%8.4f\t%1d\t%8.4f\t%1d\t%d\t%d",
-                    devProp[type][i].getDeviceExperience(), devProp[type][i].deviceHeld, devProp[type][i].idleDevice,
+                    devProp[type][i].getDeviceExperience(), devProp[type][i].getDeviceHeld(), devProp[type][i].idleDevice,
                     devProp[type][i].devicesToMake, devProp[type][i].devicesSetAside, devProp[type][i].gainOverDeviceLifeMemory,
                     devProp[type][i].gainOverDeviceLifeMemoryValid, devProp[type][i].costOfDeviceMemory,
                     devProp[type][i].costOfDeviceMemoryValid, devProp[type][i].devicesMadeToday, devProp[type][i].devicesMadeTotal);
@@ -1909,7 +2197,7 @@ void Agent::logAgentData()
 
 #if 0
             LOG(5) << "dev " << i << ", " << type << " deviceExperience  " << devProp[type][i].getDeviceExperience();
-            LOG(5) << "dev " << i << ", " << type << " deviceHeld " << devProp[type][i].deviceHeld;
+            LOG(5) << "dev " << i << ", " << type << " deviceHeld " << devProp[type][i].getDeviceHeld();
             LOG(5) << "dev " << i << ", " << type << " idleDevice " << devProp[type][i].idleDevice;
             LOG(5) << "dev " << i << ", " << type << " devicesToMake " << devProp[type][i].devicesToMake;
             LOG(5) << "dev " << i << ", " << type << " devicesSetAside " << devProp[type][i].devicesSetAside;
@@ -1928,3 +2216,82 @@ void Agent::logAgentData()
     //    LOG(5) << " --- agentDeviceTradeMemory ---";
 
 }
+
+/**
+ * Write the values of the agent that change during a run to a day status
+ * file (see Utils::saveDayStatus()).  personalValues is written by the
+ * caller, since it is needed to construct the agent again.
+ * deviceBoughtThisRound and tradedDeviceWithThisRound are not written:
+ * they are cleared before each round of device trading.
+ */
+void Agent::saveState(ostream &out) const
+{
+    writeBinary(out, inSimulation);
+    writeBinary(out, penalty);
+    writeBinary(out, endDayGPM);
+    writeBinary(out, setAsideTime);
+    writeBinary(out, overtime);
+    writeBinary(out, agentDeviceTradeMemory);
+    writeBinary(out, unitsSoldToday);
+    writeBinary(out, unitsSoldForDevicesToday);
+    writeBinary(out, unitsSoldCrossGroupToday);
+    writeBinary(out, unitsSoldCrossGroupForDevicesToday);
+    writeBinary(out, unitsGatheredWithDeviceToday);
+    writeBinary(out, unitsGatheredWithoutDeviceToday);
+    writeBinary(out, unitsExtractedWithDeviceTodayByRes);
+    writeBinary(out, devicesMadeWithDevDevicesToday);
+    writeBinary(out, timeSpentMakingDevicesToday);
+    writeBinary(out, timeSpentMakingDevicesTodayByDeviceByRes);
+    writeBinary(out, timeSpentGatheringWithDeviceToday);
+    writeBinary(out, timeSpentGatheringWithDeviceTodayByRes);
+    writeBinary(out, timeSpentGatheringWithoutDeviceToday);
+    writeBinary(out, timeSpentGatheringWithoutDeviceTodayByRes);
+    writeBinary(out, utilityToday);
+    writeBinary(out, utilGainThroughDevSoldToday);
+    for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+        resProp[resId].saveState(out);
+    }
+    for (int type = 0; type < NUM_DEVICE_TYPES; type++) {
+        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+            devProp[type][resId].saveState(out);
+        }
+    }
+}
+
+/**
+ * Read back the values written by saveState() into an agent just
+ * constructed from the saved personalValues.
+ */
+void Agent::loadState(istream &in)
+{
+    readBinary(in, inSimulation);
+    readBinary(in, penalty);
+    readBinary(in, endDayGPM);
+    readBinary(in, setAsideTime);
+    readBinary(in, overtime);
+    readBinary(in, agentDeviceTradeMemory);
+    readBinary(in, unitsSoldToday);
+    readBinary(in, unitsSoldForDevicesToday);
+    readBinary(in, unitsSoldCrossGroupToday);
+    readBinary(in, unitsSoldCrossGroupForDevicesToday);
+    readBinary(in, unitsGatheredWithDeviceToday);
+    readBinary(in, unitsGatheredWithoutDeviceToday);
+    readBinary(in, unitsExtractedWithDeviceTodayByRes);
+    readBinary(in, devicesMadeWithDevDevicesToday);
+    readBinary(in, timeSpentMakingDevicesToday);
+    readBinary(in, timeSpentMakingDevicesTodayByDeviceByRes);
+    readBinary(in, timeSpentGatheringWithDeviceToday);
+    readBinary(in, timeSpentGatheringWithDeviceTodayByRes);
+    readBinary(in, timeSpentGatheringWithoutDeviceToday);
+    readBinary(in, timeSpentGatheringWithoutDeviceTodayByRes);
+    readBinary(in, utilityToday);
+    readBinary(in, utilGainThroughDevSoldToday);
+    for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+        resProp[resId].loadState(in);
+    }
+    for (int type = 0; type < NUM_DEVICE_TYPES; type++) {
+        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+            devProp[type][resId].loadState(in);
+        }
+    }
+}
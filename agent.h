@@ -4,6 +4,7 @@
 #include <vector>
 #include "properties.h"
 #include "globals.h"
+#include "randomstream.h"
 using namespace std;
 
 /**
@@ -24,6 +25,8 @@ class Agent
 private:
     void initializeAll(int number, vector< vector<double> > agentValues);
     void defineProperties();
+    void forgetDeviceMemory(device_name_t type, int use, device_memory_t memory);
+    void forgetDeviceCostMemory(device_name_t type, int use);
 
 public:
     /**
@@ -72,6 +75,12 @@ public:
      * calculate opportunity costs.
      */
     double endDayGPM;
+    /**
+     * Counts the refreshes of the agent's memories of the gains, costs
+     * and worst case constructions of devices (see
+     * refreshDeviceGainAndCostMemory()).
+     */
+    int deviceMemoryEpoch;
     /**
      * When deciding how many tools an agent can make, agents keep track
      * of how much time it must set aside to build those tools.
@@ -98,9 +107,9 @@ public:
 
     /**
      * Tracks which agents this agent has traded devices with in the
-     * given round of device trading.
+     * given round of device trading (indexed by agent name).
      */
-    vector<Agent *> tradedDeviceWithThisRound;
+    vector<bool> tradedDeviceWithThisRound;
     /**
      * Keeps track of the number of units of all resources this agent
      * has sold.
@@ -214,11 +223,14 @@ public:
     device_name_t bestDevice(int resIndex) const;
     device_name_t bestDevDevice(device_name_t device, int deviceIndex) const;
     void workDay();
+    double extractUnit(int resIndex, vector<double> &valuePerEfforts);
+    int extractRun(int resIndex, double otherMax, double epsilon,
+                   vector<double> &valuePerEfforts, double &time);
     // vtn2: note: A better name would probably be extractWithDevice.
     void deviceUse(device_name_t device, int deviceIndex, double timeChange);
     bool resBundleHeldCheck(vector<int> bundle) const;
     void toolInvention();
-    void deviceInvention(device_name_t device, device_name_t componentType);
+    void deviceInvention(device_name_t device, device_name_t componentType, RandomStream &rng);
     void makeDevice(int deviceIndex, device_name_t device);
     void work(int resIndex, device_name_t bestDevice);
     void workStatsUpdate(int resIndex, device_name_t bestDevice, double workTime);
@@ -250,7 +262,6 @@ public:
     double utilityHeld(int resIndex);
     double costOfResourceBundle(vector<int> &resourceBundle) const;
     double gainOfResourceBundle(vector<int> &resourceBundle) const;
-    double myAccumulate(int resIndex, int change) const;
     double barterUtility(int resIndex, int change) const;
     double deviceCurrentlyHeldForResource(int resIndex, device_name_t device) const;
     void personalDevices(device_name_t device);
@@ -258,12 +269,19 @@ public:
     void calcUtilityToday();
     void newDeviceTrade (device_name_t device);
     void resetDeviceGainAndCostMemory();
+    void refreshDeviceGainAndCostMemory();
+    bool recallsDeviceMemory(device_name_t type, int use, device_memory_t memory);
+    void storesDeviceMemory(device_name_t type, int use, device_memory_t memory);
+    void forgetDeviceMemoryOfRes(int resId);
+    void forgetDeviceMemoryOfDevice(device_name_t type, int use);
     void resetTodayStats();
     void remove();
     int calcMinHeld();
     int calcMaxHeld();
     MaxInfo calcMaxDeviceGainAndIndex(device_name_t deviceType);
     void logAgentData();
+    void saveState(ostream &out) const;
+    void loadState(istream &in);
 };
 
 
@@ -288,7 +306,7 @@ inline double Agent::utilPerEffort(int resIndex) const
  */
 inline double Agent::devDeviceHeldForRes(device_name_t type, int resIndex) const
 {
-    return devProp[type][resIndex].deviceHeld;
+    return devProp[type][resIndex].getDeviceHeld();
 }
 
 /**
@@ -327,8 +345,8 @@ inline double Agent::utilityHeld(int resIndex)
 inline double Agent::utilCalc(int resIndex) const
 {
     int i = resHeld(resIndex);
-    if (i < (int) resProp[resIndex].marginalUtilities.size()) {
-        return resProp[resIndex].marginalUtilities[i];
+    if (i < (int) resProp[resIndex].getMarginalUtilities().size()) {
+        return resProp[resIndex].getMarginalUtilities()[i];
     }
     return glob.MIN_RES_UTIL;
 }
@@ -345,8 +363,8 @@ inline double Agent::tempUtilCalc(int resIndex, int change) const
      * inventory without actually changing the inventory.
      */
     int i = resHeld(resIndex) + change;
-    if (i < (int) resProp[resIndex].marginalUtilities.size()) {
-        return resProp[resIndex].marginalUtilities[i];
+    if (i < (int) resProp[resIndex].getMarginalUtilities().size()) {
+        return resProp[resIndex].getMarginalUtilities()[i];
     }
     return glob.MIN_RES_UTIL;
 }
@@ -358,14 +376,14 @@ inline double Agent::tempUtilCalc(int resIndex, int change) const
  */
 inline double Agent::effortCalc(int resIndex) const
 {
-    int temp = (int) resProp[resIndex].experience;
+    int temp = (int) resProp[resIndex].getExperience();
     /*
      * PROBLEM: to be the same with python, should be:
      * Gives an error if effortCalc() uses glob and tempEffortCalc() doesn't use glob.
      * Doesn't give an error if they both use resProp instead of glob.
      */
-     if (temp < (int) resProp[resIndex].resEfforts.size()) {
-         return resProp[resIndex].resEfforts[temp];
+     if (temp < (int) resProp[resIndex].getResEfforts().size()) {
+         return resProp[resIndex].getResEfforts()[temp];
      }
      return resProp[resIndex].minResEffort;
 }
@@ -380,9 +398,9 @@ inline double Agent::effortCalc(int resIndex) const
  */
 inline double Agent::tempEffortCalc(int resIndex, double change) const
 {
-    int temp = (int) (resProp[resIndex].experience + change);
-    if (temp < (int) resProp[resIndex].resEfforts.size()) {
-    	return resProp[resIndex].resEfforts[temp];
+    int temp = (int) (resProp[resIndex].getExperience() + change);
+    if (temp < (int) resProp[resIndex].getResEfforts().size()) {
+    	return resProp[resIndex].getResEfforts()[temp];
     }
     return resProp[resIndex].minResEffort;
 }
@@ -395,8 +413,8 @@ inline double Agent::tempEffortCalc(int resIndex, double change) const
 inline double Agent::deviceEffortCalc(int deviceIndex, device_name_t device)
 {
     int temp = (int) devProp[device][deviceIndex].getDeviceExperience();
-    if (temp < (int) devProp[device][deviceIndex].deviceEfforts.size()) {
-    	return devProp[device][deviceIndex].deviceEfforts[temp];
+    if (temp < (int) devProp[device][deviceIndex].getDeviceEfforts().size()) {
+    	return devProp[device][deviceIndex].getDeviceEfforts()[temp];
     }
     return devProp[device][deviceIndex].minDeviceEffort;
 }
@@ -410,8 +428,8 @@ inline double Agent::tempDeviceEffortCalc(int deviceIndex, device_name_t device,
                                           double change)
 {
     int temp = (int) (devProp[device][deviceIndex].getDeviceExperience() + change);
-    if (temp < (int) devProp[device][deviceIndex].deviceEfforts.size()){
-    	return devProp[device][deviceIndex].deviceEfforts[temp];
+    if (temp < (int) devProp[device][deviceIndex].getDeviceEfforts().size()){
+    	return devProp[device][deviceIndex].getDeviceEfforts()[temp];
     }
     return devProp[device][deviceIndex].minDeviceEffort;
 }
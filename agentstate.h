@@ -0,0 +1,60 @@
+/**
+ * The agentstate module includes the definition of the AgentState class,
+ * which keeps the fields of the agents' ResProperties and DevProperties
+ * that are read in the hot loops (the units held, the experience and the
+ * minutes of devices held) in one contiguous array per field, indexed
+ * [agent][res] or [devType][agent][res].  A row of an array holds the
+ * values of one agent (and device type) for all resources, so the loops
+ * over the resources of an agent, or over all the agents, stream through
+ * memory instead of striding over the rest of the properties.
+ *
+ * ResProperties and DevProperties point to their slots in the arrays (see
+ * Agent::defineProperties()); the arrays are sized for a run by reset()
+ * before its agents are made, and must not be resized while they live.
+ */
+
+#ifndef _SOC_AGENTSTATE_H_
+#define _SOC_AGENTSTATE_H_
+
+#include <vector>
+
+using namespace std;
+
+class AgentState
+{
+private:
+    int numAgents;
+    int numResources;
+    int numDeviceTypes;
+    vector<int> held;               //!< [agent][res]
+    vector<double> experience;      //!< [agent][res]
+    vector<double> deviceHeld;      //!< [devType][agent][res]
+
+public:
+    AgentState() : numAgents(0), numResources(0), numDeviceTypes(0) {}
+
+    /**
+     * Size the arrays for a run and set all the values to 0.
+     */
+    void reset(int agents, int resources, int deviceTypes)
+    {
+        numAgents = agents;
+        numResources = resources;
+        numDeviceTypes = deviceTypes;
+        held.assign(numAgents * numResources, 0);
+        experience.assign(numAgents * numResources, 0.0);
+        deviceHeld.assign(numDeviceTypes * numAgents * numResources, 0.0);
+    }
+
+    int *heldRow(int agent) { return &held[agent * numResources]; }
+    double *experienceRow(int agent) { return &experience[agent * numResources]; }
+    double *deviceHeldRow(int type, int agent) { return &deviceHeld[(type * numAgents + agent) * numResources]; }
+
+    /**
+     * \return the units held of each resource by each agent, agent after agent.
+     */
+    const vector<int> &allHeld() const { return held; }
+};
+
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * The binaryio module includes the functions used to write and read the
+ * day status files (see Utils::saveDayStatus()).  Numbers are written as
+ * their raw bytes, in the byte order of the machine; a vector or a string
+ * is written as its length followed by its elements.
+ */
+
+#ifndef _SOC_BINARYIO_H_
+#define _SOC_BINARYIO_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+using namespace std;
+
+/*
+ * Declared up front so that the templates below find each other when the
+ * elements are themselves vectors or pairs.
+ */
+template <class A, class B> void writeBinary(ostream &out, const pair<A, B> &value);
+template <class T> void writeBinary(ostream &out, const vector<T> &value);
+template <class A, class B> void readBinary(istream &in, pair<A, B> &value);
+template <class T> void readBinary(istream &in, vector<T> &value);
+
+/**
+ * Write a number (int, double, bool, an enum, ...) to out.
+ */
+template <class T>
+inline void writeBinary(ostream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+inline void writeBinary(ostream &out, const string &value)
+{
+    uint32_t len = value.size();
+    writeBinary(out, len);
+    out.write(value.data(), len);
+}
+
+template <class A, class B>
+inline void writeBinary(ostream &out, const pair<A, B> &value)
+{
+    writeBinary(out, value.first);
+    writeBinary(out, value.second);
+}
+
+template <class T>
+inline void writeBinary(ostream &out, const vector<T> &value)
+{
+    uint32_t len = value.size();
+    writeBinary(out, len);
+    for (uint32_t i = 0; i < len; i++) {
+        writeBinary(out, value[i]);
+    }
+}
+
+/**
+ * Read a number written by writeBinary() into value.
+ */
+template <class T>
+inline void readBinary(istream &in, T &value)
+{
+    in.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+inline void readBinary(istream &in, string &value)
+{
+    uint32_t len = 0;
+    readBinary(in, len);
+    value.clear();
+    if (in) {
+        value.resize(len);
+        in.read(&value[0], len);
+    }
+}
+
+template <class A, class B>
+inline void readBinary(istream &in, pair<A, B> &value)
+{
+    readBinary(in, value.first);
+    readBinary(in, value.second);
+}
+
+template <class T>
+inline void readBinary(istream &in, vector<T> &value)
+{
+    uint32_t len = 0;
+    readBinary(in, len);
+    value.clear();
+    // stop at the end of a truncated file instead of trusting len
+    for (uint32_t i = 0; i < len && in; i++) {
+        value.push_back(T());
+        readBinary(in, value.back());
+    }
+}
+
+
+#endif
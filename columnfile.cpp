@@ -0,0 +1,162 @@
+/**
+ * Columnar binary tables of results (see columnfile.h for the layout).
+ */
+#include <sstream>
+#include <algorithm>
+#include "columnfile.h"
+#include "binaryio.h"
+
+static const char COLUMN_FILE_MAGIC[8] = { 'S', 'O', 'C', 'C', 'O', 'L', 'S', '\0' };
+static const uint32_t COLUMN_FILE_VERSION = 1;
+
+/**
+ * Constructor.
+ * \param columnSpecs the columns of the table
+ */
+ColumnChunk::ColumnChunk(const vector<ColumnSpec> &columnSpecs)
+{
+    specs = columnSpecs;
+    strings.resize(specs.size());
+    ints.resize(specs.size());
+    doubles.resize(specs.size());
+    rows = 0;
+}
+
+/**
+ * Drop all the rows, keeping the storage for the next ones.
+ */
+void ColumnChunk::clear()
+{
+    for (unsigned col = 0; col < specs.size(); col++) {
+        strings[col].clear();
+        ints[col].clear();
+        doubles[col].clear();
+    }
+    rows = 0;
+}
+
+/**
+ * \param columnSpecs the columns of the table
+ * \return the bytes a column file of the given columns starts with.
+ */
+string ColumnChunk::header(const vector<ColumnSpec> &columnSpecs)
+{
+    ostringstream out;
+    out.write(COLUMN_FILE_MAGIC, sizeof(COLUMN_FILE_MAGIC));
+    writeBinary(out, COLUMN_FILE_VERSION);
+    uint32_t numColumns = columnSpecs.size();
+    writeBinary(out, numColumns);
+    for (unsigned col = 0; col < columnSpecs.size(); col++) {
+        writeBinary(out, columnSpecs[col].name);
+        uint8_t type = columnSpecs[col].type;
+        writeBinary(out, type);
+    }
+    return out.str();
+}
+
+/**
+ * Read the header of a column file.
+ * \param in the file
+ * \param columnSpecs set to the columns of the table
+ * \return false (after telling why on cerr) if in is not a column file.
+ */
+bool ColumnChunk::readHeader(istream &in, vector<ColumnSpec> &columnSpecs)
+{
+    char magic[sizeof(COLUMN_FILE_MAGIC)];
+    uint32_t version = 0;
+    uint32_t numColumns = 0;
+    in.read(magic, sizeof(magic));
+    readBinary(in, version);
+    readBinary(in, numColumns);
+    if (! in || ! equal(magic, magic + sizeof(magic), COLUMN_FILE_MAGIC)) {
+        cerr << "not a column file" << endl;
+        return false;
+    }
+    if (version != COLUMN_FILE_VERSION) {
+        cerr << "column file version " << version << ", this program reads version " <<
+            COLUMN_FILE_VERSION << endl;
+        return false;
+    }
+    columnSpecs.clear();
+    for (uint32_t col = 0; col < numColumns && in; col++) {
+        ColumnSpec spec;
+        uint8_t type = 0;
+        readBinary(in, spec.name);
+        readBinary(in, type);
+        spec.type = (column_type_t) type;
+        columnSpecs.push_back(spec);
+    }
+    return (bool) in;
+}
+
+/**
+ * \return the bytes of the rows added so far, as one chunk.
+ */
+string ColumnChunk::serialize() const
+{
+    ostringstream out;
+    uint32_t numRows = rows;
+    writeBinary(out, numRows);
+    for (unsigned col = 0; col < specs.size(); col++) {
+        switch (specs[col].type) {
+        case STRING_COLUMN:
+            for (int row = 0; row < rows; row++) {
+                writeBinary(out, strings[col][row]);
+            }
+            break;
+        case INT_COLUMN:
+            if (rows > 0) {
+                out.write(reinterpret_cast<const char *>(&ints[col][0]), rows * sizeof(int32_t));
+            }
+            break;
+        case DOUBLE_COLUMN:
+            if (rows > 0) {
+                out.write(reinterpret_cast<const char *>(&doubles[col][0]), rows * sizeof(double));
+            }
+            break;
+        }
+    }
+    return out.str();
+}
+
+/**
+ * Replace the rows with those of the next chunk of in.
+ * \return false at the end of the file or of its last complete chunk.
+ */
+bool ColumnChunk::read(istream &in)
+{
+    clear();
+    uint32_t numRows = 0;
+    readBinary(in, numRows);
+    if (! in) {
+        return false;
+    }
+    for (unsigned col = 0; col < specs.size() && in; col++) {
+        switch (specs[col].type) {
+        case STRING_COLUMN:
+            strings[col].resize(numRows);
+            for (uint32_t row = 0; row < numRows && in; row++) {
+                readBinary(in, strings[col][row]);
+            }
+            break;
+        case INT_COLUMN:
+            ints[col].resize(numRows);
+            if (numRows > 0) {
+                in.read(reinterpret_cast<char *>(&ints[col][0]), numRows * sizeof(int32_t));
+            }
+            break;
+        case DOUBLE_COLUMN:
+            doubles[col].resize(numRows);
+            if (numRows > 0) {
+                in.read(reinterpret_cast<char *>(&doubles[col][0]), numRows * sizeof(double));
+            }
+            break;
+        }
+    }
+    if (! in) {
+        clear();
+        return false;
+    }
+    rows = numRows;
+    return true;
+}
@@ -0,0 +1,75 @@
+/**
+ * The columnfile module includes the definition of the ColumnChunk class,
+ * used to write tables of results in a columnar binary file instead of a
+ * CSV file (see --binary-output), and to read them back (see socb2csv).
+ *
+ * A column file is self-describing: it starts with a magic string, a
+ * version and the name and type of each column, followed by any number of
+ * chunks.  A chunk is a number of rows followed by the values of each
+ * column for those rows, one column after the other.  Numbers are written
+ * as in binaryio.h; missing values of double columns are NaN.  Chunks are
+ * only ever appended, so a file cut short by a killed run is readable up
+ * to its last complete chunk.
+ */
+
+#ifndef _SOC_COLUMNFILE_H_
+#define _SOC_COLUMNFILE_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * \enum column_type_t
+ * The type of the values of a column.
+ */
+enum column_type_t {
+    STRING_COLUMN = 0,
+    INT_COLUMN,     /*!< 1 */
+    DOUBLE_COLUMN   /*!< 2 */
+};
+
+/**
+ * \struct ColumnSpec
+ * The name and type of a column.
+ */
+struct ColumnSpec {
+    string name;
+    column_type_t type;
+};
+
+class ColumnChunk
+{
+private:
+    vector<ColumnSpec> specs;
+    vector<vector<string> > strings;    //!< the values of each string column
+    vector<vector<int32_t> > ints;      //!< the values of each int column
+    vector<vector<double> > doubles;    //!< the values of each double column
+    int rows;
+
+public:
+    ColumnChunk(const vector<ColumnSpec> &columnSpecs);
+    int numRows() const { return rows; }
+    const vector<ColumnSpec> &getSpecs() const { return specs; }
+
+    void addString(int col, const string &value) { strings[col].push_back(value); }
+    void addInt(int col, int32_t value) { ints[col].push_back(value); }
+    void addDouble(int col, double value) { doubles[col].push_back(value); }
+    void endRow() { rows++; }
+    void clear();
+
+    const string &getString(int col, int row) const { return strings[col][row]; }
+    int32_t getInt(int col, int row) const { return ints[col][row]; }
+    double getDouble(int col, int row) const { return doubles[col][row]; }
+
+    static string header(const vector<ColumnSpec> &columnSpecs);
+    static bool readHeader(istream &in, vector<ColumnSpec> &columnSpecs);
+    string serialize() const;
+    bool read(istream &in);
+};
+
+
+#endif
@@ -7,6 +7,7 @@
 #include <boost/foreach.hpp>
 #include "device.h"
 #include "agent.h"
+#include "profiler.h"
 using namespace std;
 
 /**
@@ -25,10 +26,33 @@ Device::Device(device_name_t componentType, device_name_t type, device_name_t ca
     this->use = use;
     this->deviceFactor = deviceFactor;
     this->lifetime = lifetime;
+    /*
+     * Link the device with its components, the resources of a tool or the
+     * devices of the other types.
+     */
+    for (int i = 0; i < (int) components.size(); i++) {
+        if (componentType == NO_DEVICE) {
+            glob.res[components[i]].usedIn.push_back(this);
+        } else {
+            glob.discoveredDevices[componentType][components[i]]->usedIn.push_back(this);
+        }
+    }
     // what about necessaryResources?  Currently called in each subclass constructor, but could
     // be called here instead, perhaps...
 }
 
+/**
+ * Destructor: the components of the device are no longer used in it.
+ */
+Device::~Device()
+{
+    for (int i = 0; i < (int) components.size(); i++) {
+        vector<Device *> &users = (componentType == NO_DEVICE) ?
+            glob.res[components[i]].usedIn : glob.discoveredDevices[componentType][components[i]]->usedIn;
+        users.erase(remove(users.begin(), users.end(), this), users.end());
+    }
+}
+
 /**
  * \return the number of agents that have enough experience in this device
  */
@@ -49,7 +73,7 @@ int Device::agentsKnown()
  */
 double Device::costs(Agent &agent)
 {
-    if (agent.devProp[type][use].costOfDeviceMemoryValid) {
+    if (agent.recallsDeviceMemory(type, use, COST_MEMORY)) {
         return agent.devProp[type][use].costOfDeviceMemory;
     } else {
         /* canBuy returns a boolean and a double */
@@ -105,7 +129,7 @@ double Device::costs(Agent &agent)
                 cost += glob.discoveredDevices[componentType][comp]->costs(agent);
             }
             agent.devProp[type][use].costOfDeviceMemory = cost;
-            agent.devProp[type][use].costOfDeviceMemoryValid = true;
+            agent.storesDeviceMemory(type, use, COST_MEMORY);
             return cost;
         }
     }
@@ -152,11 +176,12 @@ double Device::expectedConstructionTime(Agent &agent)
  */
 pair<double, vector<int> > Device::worstCaseConstruction(Agent &agent)
 {
+    prof.count(WORST_CASE_CONSTRUCTION_COUNT);
     /*
      * If the memory of this calculation that the agent has is valid, return
      * the value in memory
      */
-    if (agent.devProp[type][use].worstCaseConstructionMemoryValid) {
+    if (agent.recallsDeviceMemory(type, use, WORST_CASE_MEMORY)) {
         return agent.devProp[type][use].worstCaseConstructionMemory;
     } else {
         /*
@@ -179,7 +204,7 @@ pair<double, vector<int> > Device::worstCaseConstruction(Agent &agent)
          */
         double timeNeeded = 0.0;
         if (devDevice != NO_DEVICE &&
-            agent.devProp[devDevice][use].deviceHeld > 0.0) {
+            agent.devProp[devDevice][use].getDeviceHeld() > 0.0) {
             timeNeeded = agent.deviceEffortCalc(use, type) /
                 glob.discoveredDevices[devDevice][use]->deviceFactor;
         } else {
@@ -220,7 +245,7 @@ pair<double, vector<int> > Device::worstCaseConstruction(Agent &agent)
                      * divided by lifetime per device)
                      */
                     compNeeded[resId] = max(0, compNeeded[resId] -
-                                                (int(agent.devProp[compType][resId].deviceHeld)
+                                                (int(agent.devProp[compType][resId].getDeviceHeld())
                                                         / int(glob.discoveredDevices[compType][resId]->lifetime)));
                 }
             }
@@ -239,7 +264,7 @@ pair<double, vector<int> > Device::worstCaseConstruction(Agent &agent)
                      */
                     double devDeviceFactor = 1.0;
                     if (devDevice != NO_DEVICE &&
-                        agent.devProp[devDevice][resId].deviceHeld > 0.0) {
+                        agent.devProp[devDevice][resId].getDeviceHeld() > 0.0) {
                         devDeviceFactor = glob.discoveredDevices[devDevice][resId]->deviceFactor;
                     }
                     for (int i = 0; i < compNeeded[resId]; i++) {
@@ -279,7 +304,7 @@ pair<double, vector<int> > Device::worstCaseConstruction(Agent &agent)
 
         // Agents remember this calculated list
         agent.devProp[type][use].worstCaseConstructionMemory = make_pair(timeNeeded, necessaryRes);
-        agent.devProp[type][use].worstCaseConstructionMemoryValid = true;
+        agent.storesDeviceMemory(type, use, WORST_CASE_MEMORY);
         return pair<double, vector<int> >(timeNeeded, necessaryRes);
     }
 }
@@ -347,10 +372,8 @@ bool DevDevice::wantsToConsiderDevDevice(Agent &agent)
     // computations only if the first class of the return part below is true.
     int numAgentCurrentlyHeld, sum;
     if (agent.devDeviceHeldForRes(type, use) < glob.DAYS_OF_DEVICE_TO_HOLD * glob.DAY_LENGTH) {
-        numAgentCurrentlyHeld = int(agent.devProp[type][use].deviceHeld / lifetime);
-        sum = accumulate(agent.devProp[canMake][use].devicesRecentlyMade.begin(),
-                             agent.devProp[canMake][use].devicesRecentlyMade.end(),
-                             0);
+        numAgentCurrentlyHeld = int(agent.devProp[type][use].getDeviceHeld() / lifetime);
+        sum = agent.devProp[canMake][use].devicesRecentlyMade.total();
     } else {
         return false;
     }
@@ -373,10 +396,10 @@ double DevDevice::gainOverLifetime(Agent &agent)
         // devDevice, the time saved multiplied by the gain per minute
         // that the agent had at the end of the last work day is the
         // gain associated with this device.
-        if (agent.devProp[type][use].gainOverDeviceLifeMemoryValid) {
+        if (agent.recallsDeviceMemory(type, use, GAIN_MEMORY)) {
             return agent.devProp[type][use].gainOverDeviceLifeMemory;
         } else {
-            double devDeviceHeld = agent.devProp[type][use].deviceHeld;
+            double devDeviceHeld = agent.devProp[type][use].getDeviceHeld();
             double heldDeviceUseTime = 0.0;
             double deviceExperienceGained = 0.0;
             while (devDeviceHeld - heldDeviceUseTime > 0.0) {
@@ -401,7 +424,7 @@ double DevDevice::gainOverLifetime(Agent &agent)
             }
             double timeGained = noDeviceUseTime - deviceUseTime;
             agent.devProp[type][use].gainOverDeviceLifeMemory = timeGained * agent.endDayGPM;
-            agent.devProp[type][use].gainOverDeviceLifeMemoryValid = true;
+            agent.storesDeviceMemory(type, use, GAIN_MEMORY);
 
             return timeGained * agent.endDayGPM;
         }
@@ -448,7 +471,7 @@ Tool::Tool(vector<int> &components, int use) :
  */
 double Tool::costs(Agent &agent)
 {
-    if (agent.devProp[type][use].costOfDeviceMemoryValid) {
+    if (agent.recallsDeviceMemory(type, use, COST_MEMORY)) {
         return agent.devProp[type][use].costOfDeviceMemory;
     } else {
         pair< bool, double > buy = agent.canBuy(*this);
@@ -456,7 +479,7 @@ double Tool::costs(Agent &agent)
         double avgPrice = buy.second;
         if (canBuy) {
             agent.devProp[type][use].costOfDeviceMemory = avgPrice;
-            agent.devProp[type][use].costOfDeviceMemoryValid = true;
+            agent.storesDeviceMemory(type, use, COST_MEMORY);
             return avgPrice;
         } else {
             device_name_t bestDevDevice = agent.bestDevDevice(type, use);
@@ -472,7 +495,7 @@ double Tool::costs(Agent &agent)
                 cost += agent.tempUtilCalc(comp, -1);
             }
             agent.devProp[type][use].costOfDeviceMemory = cost;
-            agent.devProp[type][use].costOfDeviceMemoryValid = true;
+            agent.storesDeviceMemory(type, use, COST_MEMORY);
             return cost;
         }
     }
@@ -511,13 +534,13 @@ double Tool::gainOverLifetime(Agent &agent)
     if (agent.deviceHeldForRes(use) > glob.DAYS_OF_DEVICE_TO_HOLD * glob.DAY_LENGTH ||
         (! glob.res[use].inSimulation)) {
         utilTool = 0;
-    } else if (agent.devProp[type][use].gainOverDeviceLifeMemoryValid) {
+    } else if (agent.recallsDeviceMemory(type, use, GAIN_MEMORY)) {
         utilTool = agent.devProp[type][use].gainOverDeviceLifeMemory;
     } else {
-        double toolHeld = agent.devProp[TOOL][use].deviceHeld;
-        double machineHeld = agent.devProp[MACHINE][use].deviceHeld;
-        double factoryHeld = agent.devProp[FACTORY][use].deviceHeld;
-        double industryHeld = agent.devProp[INDUSTRY][use].deviceHeld;
+        double toolHeld = agent.devProp[TOOL][use].getDeviceHeld();
+        double machineHeld = agent.devProp[MACHINE][use].getDeviceHeld();
+        double factoryHeld = agent.devProp[FACTORY][use].getDeviceHeld();
+        double industryHeld = agent.devProp[INDUSTRY][use].getDeviceHeld();
         double machineFactor = 0.0, factoryFactor = 0.0, industryFactor = 0.0;
         if (machineHeld > 0) {
             machineFactor = glob.discoveredDevices[MACHINE][use]->deviceFactor;
@@ -563,7 +586,7 @@ double Tool::gainOverLifetime(Agent &agent)
             unitsMade++;
         }
         agent.devProp[type][use].gainOverDeviceLifeMemory = utilTool;
-        agent.devProp[type][use].gainOverDeviceLifeMemoryValid = true;
+        agent.storesDeviceMemory(type, use, GAIN_MEMORY);
     }
     return utilTool;
 }
@@ -603,13 +626,13 @@ double Machine::gainOverLifetime(Agent &agent)
         (! glob.res[use].inSimulation)) {
         utilMachine = 0;
     }
-    else if (agent.devProp[type][use].gainOverDeviceLifeMemoryValid) {
+    else if (agent.recallsDeviceMemory(type, use, GAIN_MEMORY)) {
         utilMachine = agent.devProp[type][use].gainOverDeviceLifeMemory;
     }
     else {
-        double machineHeld = agent.devProp[MACHINE][use].deviceHeld;
-        double factoryHeld = agent.devProp[FACTORY][use].deviceHeld;
-        double industryHeld = agent.devProp[INDUSTRY][use].deviceHeld;
+        double machineHeld = agent.devProp[MACHINE][use].getDeviceHeld();
+        double factoryHeld = agent.devProp[FACTORY][use].getDeviceHeld();
+        double industryHeld = agent.devProp[INDUSTRY][use].getDeviceHeld();
         double factoryFactor = 0.0, industryFactor = 0.0;
         if (factoryHeld > 0) {
             factoryFactor = glob.discoveredDevices[FACTORY][use]->deviceFactor;
@@ -645,7 +668,7 @@ double Machine::gainOverLifetime(Agent &agent)
             unitsMade++;
         }
         agent.devProp[type][use].gainOverDeviceLifeMemory = utilMachine;
-        agent.devProp[type][use].gainOverDeviceLifeMemoryValid = true;
+        agent.storesDeviceMemory(type, use, GAIN_MEMORY);
     }
     return utilMachine;
 }
@@ -669,11 +692,11 @@ double Factory::gainOverLifetime(Agent &agent)
     if (agent.deviceHeldForRes(use) > glob.DAYS_OF_DEVICE_TO_HOLD * glob.DAY_LENGTH ||
         (! glob.res[use].inSimulation)) {
         utilFactory = 0;
-    } else if (agent.devProp[type][use].gainOverDeviceLifeMemoryValid) {
+    } else if (agent.recallsDeviceMemory(type, use, GAIN_MEMORY)) {
         utilFactory = agent.devProp[type][use].gainOverDeviceLifeMemory;
     } else {
-        double factoryHeld = agent.devProp[FACTORY][use].deviceHeld;
-        double industryHeld = agent.devProp[INDUSTRY][use].deviceHeld;
+        double factoryHeld = agent.devProp[FACTORY][use].getDeviceHeld();
+        double industryHeld = agent.devProp[INDUSTRY][use].getDeviceHeld();
         double industryFactor = 0.0;    // TODO: device.py doesn't have this. Then what's the value of it when used later?
         if (industryHeld > 0) {
             industryFactor = glob.discoveredDevices[INDUSTRY][use]->deviceFactor;
@@ -699,7 +722,7 @@ double Factory::gainOverLifetime(Agent &agent)
             unitsMade++;
         }
         agent.devProp[type][use].gainOverDeviceLifeMemory = utilFactory;
-        agent.devProp[type][use].gainOverDeviceLifeMemoryValid = true;
+        agent.storesDeviceMemory(type, use, GAIN_MEMORY);
     }
     return utilFactory;
 }
@@ -722,10 +745,10 @@ double Industry::gainOverLifetime(Agent &agent)
     if (agent.deviceHeldForRes(use) > glob.DAYS_OF_DEVICE_TO_HOLD * glob.DAY_LENGTH ||
         (! glob.res[use].inSimulation)) {
         utilIndustry = 0;
-    } else if (agent.devProp[type][use].gainOverDeviceLifeMemoryValid) {
+    } else if (agent.recallsDeviceMemory(type, use, GAIN_MEMORY)) {
         utilIndustry = agent.devProp[type][use].gainOverDeviceLifeMemory;
     } else {
-        double industryHeld = agent.devProp[INDUSTRY][use].deviceHeld;
+        double industryHeld = agent.devProp[INDUSTRY][use].getDeviceHeld();
         double deviceUseTime = 0;
         int unitsMade = 0;
         double experienceGained = 0.0;
@@ -739,7 +762,7 @@ double Industry::gainOverLifetime(Agent &agent)
             unitsMade++;
         }
         agent.devProp[type][use].gainOverDeviceLifeMemory = utilIndustry;
-        agent.devProp[type][use].gainOverDeviceLifeMemoryValid = true;
+        agent.storesDeviceMemory(type, use, GAIN_MEMORY);
     }
     return utilIndustry;
 }
@@ -42,10 +42,18 @@ public:
      */
     device_name_t devDevice;
     device_name_t componentOf;
+    /**
+     * The discovered devices that this device is a component of (kept up
+     * to date by the constructors and the destructor, and handed on to the
+     * device that replaces this one, see Agent::toolInvention() and
+     * Agent::deviceInvention()).
+     */
+    vector<Device *> usedIn;
 
     Device(device_name_t componentType, device_name_t type,
            device_name_t canMake, device_name_t devDevice, device_name_t componentOf,
            vector<int> &components, int use, double deviceFactor, double lifetime);
+    virtual ~Device();
     int agentsKnown();
     virtual double costs(Agent &agent);
     virtual double expectedConstructionTime(Agent &agent);
@@ -37,6 +37,8 @@
 #include "devmarketplace.h"
 #include "agent.h"
 #include "logging.h"
+#include "profiler.h"
+#include "rankedset.h"
 
 using namespace std;
 
@@ -70,11 +72,14 @@ void DeviceMarketplace::tradeDevices(device_name_t device)
 void DeviceMarketplace::genDevicePairs()
 {
     Agent *partner;
-    vector<Agent *> agentList;
+    /*
+     * The names of the agents that have not been paired yet; the k-th of
+     * them is the k-th agent of glob.agent that is left.
+     */
+    RankedSet agentList(glob.agent.size());
     vector<DevicePair> pairs;
 
     BOOST_FOREACH(Agent *ag, glob.agent) {
-        agentList.push_back(ag);
         ag->deviceBoughtThisRound.clear();
     }
 
@@ -91,10 +96,8 @@ void DeviceMarketplace::genDevicePairs()
 #else
         int loc = glob.random_int(0, agentList.size()); // grab random agent location
 #endif
-        vector<Agent *>::iterator it = agentList.begin(); // iterator for the agent list
-        advance(it, loc);	     // cannot use ++ or + loc with list iterators.
-        Agent *currentTrader = *it;  // Agent * is the value at the iterator.
-        agentList.erase(it);         // remove agent at index 'it' from the list
+        Agent *currentTrader = glob.agent[agentList.select(loc)];
+        agentList.erase(currentTrader->name);   // remove the agent from the list
 
         /*
          * The agent returns an ordered list of the agents that it wants to
@@ -113,31 +116,10 @@ void DeviceMarketplace::genDevicePairs()
              * get paired up.
              */
             int pref = prefDeviceTraders[prefIdx];
-            /* check if glob.agent[pref] is in agentList */
-            bool tmpNotTraded =
-                (find(agentList.begin(), agentList.end(),
-                      glob.agent[pref]) == agentList.end());
-            
-            vector<Agent *>::iterator hasTradedThisRound =
-                find(currentTrader->tradedDeviceWithThisRound.begin(),
-                     currentTrader->tradedDeviceWithThisRound.end(),
-                     glob.agent[pref]);
-            vector<Agent *>::iterator endOfCurrentTraderVect =
-                currentTrader->tradedDeviceWithThisRound.end();
-            /*
-             * if preferred agent has not traded yet this round
-             * if preferred agent has not traded this device today with the
-             * current agent.
-             */
-            if (! tmpNotTraded && (hasTradedThisRound == endOfCurrentTraderVect)) {
-                // set partner = to partner we are working with at the moment
-                it = agentList.begin();
-                hasTradedThisRound = find(agentList.begin(), agentList.end(),
-                                          glob.agent[pref]);
-                advance(it, distance(agentList.begin(), hasTradedThisRound));
-                partner = *it;
+            if (agentList.contains(pref) && ! currentTrader->tradedDeviceWithThisRound[pref]) {
+                partner = glob.agent[pref];
                 // remove the partner from the viable partners list
-                agentList.erase(it);
+                agentList.erase(pref);
                 traded = true;
                 break;
             }
@@ -149,15 +131,11 @@ void DeviceMarketplace::genDevicePairs()
          * with today.
          */
         if (! traded) {
-            for (unsigned partnersIdx = 0; partnersIdx < agentList.size(); partnersIdx++) {
-                Agent *partners = agentList[partnersIdx];
-                if (find(currentTrader->tradedDeviceWithThisRound.begin(),
-                         currentTrader->tradedDeviceWithThisRound.end(),
-                         partners) == currentTrader->tradedDeviceWithThisRound.end()) {
-                    it = agentList.begin();
-                    advance(it, partnersIdx);
-                    partner = *it;
-                    agentList.erase(it);
+            for (int partnersIdx = 0; partnersIdx < agentList.size(); partnersIdx++) {
+                int partners = agentList.select(partnersIdx);
+                if (! currentTrader->tradedDeviceWithThisRound[partners]) {
+                    partner = glob.agent[partners];
+                    agentList.erase(partners);
                     traded = true;
                     break;
                 }
@@ -170,10 +148,8 @@ void DeviceMarketplace::genDevicePairs()
          */
         if (! traded) {
             loc = glob.random_int(0, agentList.size());
-            it = agentList.begin();
-            advance(it, loc);	// cannot use ++ or + loc with list iterators.
-            partner = *it;
-            agentList.erase(it);
+            partner = glob.agent[agentList.select(loc)];
+            agentList.erase(partner->name);
         }
 
         // add the pairs to the end of the pairs list.
@@ -219,8 +195,8 @@ void DevicePair::pairDeviceTrade()
 {
     if (currentTradeAttempts == 0) {
         // Each agent notes that it has traded with the other agent this round
-        deviceSeller->tradedDeviceWithThisRound.push_back(deviceBuyer);
-        deviceBuyer->tradedDeviceWithThisRound.push_back(deviceSeller);
+        deviceSeller->tradedDeviceWithThisRound[deviceBuyer->name] = true;
+        deviceBuyer->tradedDeviceWithThisRound[deviceSeller->name] = true;
     }
     if (deviceBuyer->inSimulation && deviceSeller->inSimulation) {
         double tempMax = 0.0;
@@ -529,6 +505,7 @@ void DevicePair::checkGains()
  */
 void DevicePair::makeTrade()
 {
+    prof.count(DEVICE_TRADE_COUNT);
     deviceSeller->sellsDevice(deviceBuyerPick, deviceType);
     deviceBuyer->buysDevice(deviceBuyerPick, deviceType);
     
@@ -536,6 +513,8 @@ void DevicePair::makeTrade()
         if (finalOffer[resId] > 0) {
             deviceBuyer->sells(resId, finalOffer[resId]);
             deviceSeller->buys(resId, finalOffer[resId]);
+            deviceBuyer->forgetDeviceMemoryOfRes(resId);
+            deviceSeller->forgetDeviceMemoryOfRes(resId);
 
             // set the data for saving end day results
             deviceBuyer->resProp[resId].soldEndDay += finalOffer[resId];
@@ -592,13 +571,11 @@ void DevicePair::agentMemoryUpdate()
         += deviceSellerUtilGain - deviceSellerUtilLoss;
     deviceBuyer->agentDeviceTradeMemory[deviceType][deviceSeller->name][0]
         += deviceBuyerUtilGain - deviceBuyerUtilLoss;
-    deviceBuyer->devProp[deviceType][deviceBuyerPick].devicePrices.pop_back();
-    vector<double>::iterator it = deviceBuyer->devProp[deviceType][deviceBuyerPick].devicePrices.begin();
-    deviceBuyer->devProp[deviceType][deviceBuyerPick].devicePrices.insert(it, deviceBuyerUtilLoss);
+    deviceBuyer->devProp[deviceType][deviceBuyerPick].devicePrices.remember(deviceBuyerUtilLoss);
+    deviceBuyer->forgetDeviceMemoryOfDevice(deviceType, deviceBuyerPick);
     deviceBuyer->deviceBoughtThisRound.push_back(deviceBuyerPick);
-    deviceSeller->devProp[deviceType][deviceBuyerPick].devicePrices.pop_back();
-    it = deviceSeller->devProp[deviceType][deviceBuyerPick].devicePrices.begin();
-    deviceSeller->devProp[deviceType][deviceBuyerPick].devicePrices.insert(it, -deviceSellerUtilGain + deviceSellerUtilLoss);
+    deviceSeller->devProp[deviceType][deviceBuyerPick].devicePrices.remember(-deviceSellerUtilGain + deviceSellerUtilLoss);
+    deviceSeller->forgetDeviceMemoryOfDevice(deviceType, deviceBuyerPick);
 }
 
 
@@ -1,4 +1,5 @@
 #include <cmath>
+#include <cstdlib>
 #include <ctime> 
 #include <string>
 #include <sstream>
@@ -16,6 +17,8 @@
 #include "statstracker.h"
 #include "devmarketplace.h"
 #include "utils.h"
+#include "threadpool.h"
+#include "binaryio.h"
 #include "logging.h"
 
 
@@ -44,6 +47,20 @@ Globals::Globals()
     SAVE_DAY_STATUS = false;
     SIM_NAME = "default";
     PARALLEL_TRADES = false;
+    BINARY_OUTPUT = false;
+    STATS_PROFILE = STATS_STANDARD;
+    PROFILE = false;
+    BRANCH_DAY = -99;
+    NUM_THREADS = 1;
+    threadPool = NULL;
+    runIndex = 0;
+    pointConfigFilename = "";
+    SWEEP_FOLDER = "";
+    resourceMarket = NULL;
+    deviceMarket = NULL;
+    productionStats = NULL;
+    tradeStats = NULL;
+    otherStats = NULL;
 }
 
 /**
@@ -51,37 +68,45 @@ Globals::Globals()
  */
 void Globals::initGlobalStructures()
 {
+    // each run of a batch gets the next seed, so run 0 is the same as a single run
     if (randomSeedSet) {
-        randGen = Ran01<double>(randomSeed);
+        randGen = Ran01<double>(randomSeed + runIndex);
     } else {
         randGen = Ran01<double>();
     }
     if (randomSeedSet) {
-        randBinomial = RanBinomial<double>(randomSeed);
+        randBinomial = RanBinomial<double>(randomSeed + runIndex);
     } else {
         randBinomial = RanBinomial<double>();
     }
+    if (randomSeedSet) {
+        streamSeed = randomSeed + runIndex;
+    } else {
+        streamSeed = GetSeed();
+    }
+
+    if (threadPool == NULL) {
+        threadPool = new ThreadPool(NUM_THREADS);
+    }
     
     discoveredDevices.resize(NUM_DEVICE_TYPES);	// there are 6 empty vectors in this vector.
     EXPERIENCE_FOR_MAKING.resize(NUM_DEVICE_TYPES);	// there are 6 empty vectors in this vector
     RES_DECAY_SLOWNESS.resize(NUM_RESOURCES);
     RES_VALUES.resize(NUM_RESOURCES);
 
-    if (START_DAY == 0) {		// if not loading a previous run
-        EXPERIENCE_FOR_MAKING.resize(NUM_DEVICE_TYPES);
-        EXPERIENCE_FOR_MAKING[TOOL] = 1.0;
-        EXPERIENCE_FOR_MAKING[MACHINE] = 2.0;
-        EXPERIENCE_FOR_MAKING[FACTORY] = 4.0;
-        EXPERIENCE_FOR_MAKING[INDUSTRY] = 8.0;
-        EXPERIENCE_FOR_MAKING[DEVMACHINE] = 4.0;
-        EXPERIENCE_FOR_MAKING[DEVFACTORY] = 8.0;
-    } else {		// not START_DAY == 0
+    EXPERIENCE_FOR_MAKING[TOOL] = 1.0;
+    EXPERIENCE_FOR_MAKING[MACHINE] = 2.0;
+    EXPERIENCE_FOR_MAKING[FACTORY] = 4.0;
+    EXPERIENCE_FOR_MAKING[INDUSTRY] = 8.0;
+    EXPERIENCE_FOR_MAKING[DEVMACHINE] = 4.0;
+    EXPERIENCE_FOR_MAKING[DEVFACTORY] = 8.0;
+
+    if (START_DAY != 0) {		// loading a previous run: see perRunInitialization()
     	DAY_STATUS_LOAD_FOLDER = "";
         int slashIdx = configFilename.find_last_of('/');
         for (unsigned i = 0; i < (unsigned) slashIdx; i++) {
         	DAY_STATUS_LOAD_FOLDER += configFilename[i];
         }
-//        loadDayStatus();	// from utils.cpp
     }
 
     // CODE HERE IN config.py to do GRAPH_X_VALUES, QUArtILE_COLORS.  Don't need to do this
@@ -96,11 +121,6 @@ void Globals::initGlobalStructures()
     RES_IN_DEV[DEVMACHINE] = RESOURCES_IN_TOOL * NUM_DEVICE_COMPONENTS * NUM_DEVICE_COMPONENTS;
     RES_IN_DEV[DEVFACTORY] = RESOURCES_IN_TOOL * NUM_DEVICE_COMPONENTS *
         NUM_DEVICE_COMPONENTS * NUM_DEVICE_COMPONENTS;   
-
-    // inizialize memoMUs
-    for (int i = 0; i < NUM_AGENT_GROUPS; i++) {
-        memoMUs.push_back(map<pair<int,int>, double>());
-    }
 }
 /**
  * Read agents values in from configAgentFilename file (the one the user set using -p or the default one),
@@ -269,15 +289,143 @@ void Globals::setAdvancedOptions()
     }
 
     SAVE_TRADES = glob.saveExchangeRateData;
+    PARALLEL_TRADES = glob.parallelTradesSet;
+    BINARY_OUTPUT = glob.binaryOutputSet;
+    STATS_PROFILE = glob.statsProfileArg;
+    PROFILE = glob.profileSet;
+
+    /*
+     * The branches share the days of the run up to the first day on which
+     * the run or any branch removes something.
+     */
+    BRANCHES.clear();
+    RunBranch noRemoval;
+    noRemoval.removeRes = false;
+    noRemoval.resToRemove = -99;
+    noRemoval.removeResDay = -99;
+    noRemoval.eliminateReserves = false;
+    noRemoval.removeAgent = false;
+    noRemoval.agentToRemove = -99;
+    noRemoval.removeAgentDay = -99;
+    for (unsigned i = 0; i + 2 < branchResArgs.size(); i += 3) {
+        RunBranch branch = noRemoval;
+        branch.removeRes = true;
+        branch.resToRemove = branchResArgs[i];
+        branch.removeResDay = branchResArgs[i + 1];
+        branch.eliminateReserves = (branchResArgs[i + 2] == 1);
+        BRANCHES.push_back(branch);
+    }
+    for (unsigned i = 0; i + 1 < branchAgentArgs.size(); i += 2) {
+        RunBranch branch = noRemoval;
+        branch.removeAgent = true;
+        branch.agentToRemove = branchAgentArgs[i];
+        branch.removeAgentDay = branchAgentArgs[i + 1];
+        BRANCHES.push_back(branch);
+    }
+    BRANCH_DAY = -99;
+    for (unsigned i = 0; i < BRANCHES.size(); i++) {
+        BRANCHES[i].saveFolder = SAVE_FOLDER + "_branch" + boost::lexical_cast<string>(i + 1);
+        int day = BRANCHES[i].removeRes ? BRANCHES[i].removeResDay : BRANCHES[i].removeAgentDay;
+        if (BRANCH_DAY == -99 || day < BRANCH_DAY) {
+            BRANCH_DAY = day;
+        }
+    }
+    if (! BRANCHES.empty()) {
+        if (REMOVE_RES && REMOVE_RES_DAY < BRANCH_DAY) {
+            BRANCH_DAY = REMOVE_RES_DAY;
+        }
+        if (REMOVE_AGENT && REMOVE_AGENT_DAY < BRANCH_DAY) {
+            BRANCH_DAY = REMOVE_AGENT_DAY;
+        }
+    }
+    BRANCH_FORK = branchForkSet;
 }
 
 /**
- * Reinitialize the variables, saving paths that need to be reinitialized for each new run.
+ * Get ready for the next run of a batch (see --runs) without parsing the
+ * config file again: reseed the random number generators, restore the
+ * options a branch may have changed and make the save folder of the run.
+ * perRunInitialization() then replaces the agents of the previous run.
+ * \param run the index of the run in the batch, from 0
+ * \param title the run number the results are saved under (see -t)
  */
-void Globals::perRunInitialization()
+void Globals::reinitialize(int run, string title)
+{
+    runIndex = run;
+    simTitle = title;
+    initGlobalStructures();
+    setAdvancedOptions();
+}
+
+/**
+ * Turn this run into the given branch: make its removal instead of the
+ * run's own and save the results in its folder.  A branch does not save
+ * a day status nor start branches of its own.
+ */
+void Globals::applyBranch(const RunBranch &branch)
+{
+    REMOVE_RES = branch.removeRes;
+    RES_TO_REMOVE = branch.resToRemove;
+    REMOVE_RES_DAY = branch.removeResDay;
+    ELIMINATE_RESERVES = branch.eliminateReserves;
+    REMOVE_AGENT = branch.removeAgent;
+    AGENT_TO_REMOVE = branch.agentToRemove;
+    REMOVE_AGENT_DAY = branch.removeAgentDay;
+    SAVE_DAY_STATUS = false;
+    if (END_SAVE) {
+        SAVE_FOLDER = branch.saveFolder;
+        createDirectory(SAVE_FOLDER);
+        createDirectory(SAVE_FOLDER + "/configFiles");
+        SIM_SAVE_FOLDER = SAVE_FOLDER + '/' + SIM_NAME;
+        createDirectory(SIM_SAVE_FOLDER);
+    }
+    BRANCHES.clear();
+    BRANCH_DAY = -99;
+}
+
+/**
+ * Delete the resources, devices, agents, marketplaces and stats of the
+ * previous run, if any.  The vectors keep their storage for the next run.
+ */
+void Globals::freeRunState()
 {
     res.clear();
     discoveredDevices.clear();
+    BOOST_FOREACH(Agent *ag, agent) {
+        delete ag;
+    }
+    agent.clear();
+    delete resourceMarket;
+    delete deviceMarket;
+    delete tradeStats;
+    delete productionStats;
+    delete otherStats;
+    resourceMarket = NULL;
+    deviceMarket = NULL;
+    tradeStats = NULL;
+    productionStats = NULL;
+    otherStats = NULL;
+    agentState.reset(NUM_AGENTS, NUM_RESOURCES, NUM_DEVICE_TYPES);
+}
+
+/**
+ * Drop the resources, devices, agents and stats of the run, so that a day
+ * status can be read in their place (see Utils::readDayStatus()).
+ */
+void Globals::clearRunState()
+{
+    freeRunState();
+    discoveredDevices.resize(NUM_DEVICE_TYPES);
+    setGlobalMarketPlaces();
+    setGlobalStats();
+}
+
+/**
+ * Reinitialize the variables, saving paths that need to be reinitialized for each new run.
+ */
+void Globals::perRunInitialization()
+{
+    freeRunState();
     discoveredDevices.resize(NUM_DEVICE_TYPES);
     if (START_DAY == 0) {
         for (int resId = 0; resId < NUM_RESOURCES; resId++) {
@@ -286,20 +434,22 @@ void Globals::perRunInitialization()
                 discoveredDevices[devId].push_back(NULL);
             }
         }
+    }
+    setGlobalMarketPlaces();
+    setGlobalStats();
+    if (START_DAY == 0) {
+        initializeAgents();
     } else {
         /*
-         * TODO: saveDayStatus and loadDayStatus in utils.cpp
+         * Restarting a saved run: res, discoveredDevices, the agents, the
+         * stats and the random number generators come from the day status
+         * saved on day START_DAY - 1 (see Utils::saveDayStatus()).
          */
-        DAY_STATUS_LOAD_FOLDER = "";
-        int slashIdx = configFilename.find_last_of('/');
-        for (unsigned i = 0; i < (unsigned) slashIdx; i++) {
-            DAY_STATUS_LOAD_FOLDER += configFilename[i];
+        if (! util.loadDayStatus()) {
+            cerr << "Could not load the day status from " << DAY_STATUS_LOAD_FOLDER << ": exiting now." << endl;
+            exit(1);
         }
     }
-    setGlobalMarketPlaces();
-    setGlobalStats();
-    initializeAgents();
-
 }
 
 /**
@@ -360,13 +510,13 @@ void Globals::removeRes(int resNumber, int day)
     res[resNumber].remove();
     BOOST_FOREACH(Agent *ag, agent) {
         for (int dev = TOOL; dev <= DEVFACTORY; dev++) {
-            ag->devProp[dev][resNumber].deviceHeld = 0;
+            ag->devProp[dev][resNumber].setDeviceHeld(0);
         }
     }
     if (ELIMINATE_RESERVES) {
         BOOST_FOREACH(Agent *ag, agent) {
             ag->resProp[resNumber].setHeld(0);
-            ag->resProp[resNumber].experience = 0;
+            ag->resProp[resNumber].setExperience(0);
         }
     }
     LOG(4) << "Res " << resNumber << " has been removed on day " << day;
@@ -414,6 +564,35 @@ int Globals::random_binomial(int n, double p)
     return randBinomial(n, p);
 }
 
+/**
+ * Write the state of randGen, randBinomial and streamSeed to a day status
+ * file, so that a restarted run draws the same numbers.
+ */
+void Globals::saveRandomState(ostream &out)
+{
+    ostringstream genState, binomialState;
+    randGen.save(genState);
+    randBinomial.save(binomialState);
+    writeBinary(out, genState.str());
+    writeBinary(out, binomialState.str());
+    writeBinary(out, streamSeed);
+}
+
+/**
+ * Read back the state written by saveRandomState().
+ */
+void Globals::loadRandomState(istream &in)
+{
+    string state;
+    readBinary(in, state);
+    istringstream genState(state);
+    randGen.load(genState);
+    readBinary(in, state);
+    istringstream binomialState(state);
+    randBinomial.load(binomialState);
+    readBinary(in, streamSeed);
+}
+
 /**
  * Reinitialize SIM_NAME and SIM_SAVE_FOLDER.
  */
@@ -4,7 +4,9 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <stdint.h>
 #include "resource.h"
+#include "agentstate.h"
 
 /**
  * \def DONT_RANDOMIZE
@@ -36,6 +38,23 @@ extern string device_names[];
 #define NUM_DEVICE_TYPES	6               /*!< \def NUM_DEVICE_TYPES */
 #define NUM_RESOURCE_GATHERING_DEVICES	4   /*!< \def NUM_RESOURCE_GATHERING_DEVICES */
 
+/**
+ * \enum stats_profile_t
+ * The daily statistics recorded (see --stats-profile).  Each profile
+ * records what the one before it does, and more.  Only the full profile
+ * keeps every day of them; the others keep the days that are still to be
+ * read, the last OUTPUT_WINDOW_DAYS days of what long_output needs and
+ * the last day of what the other files need, so that their memory does
+ * not grow with NUM_DAYS.
+ */
+enum stats_profile_t {
+    STATS_MINIMAL,	/*!< only what long_output needs */
+    STATS_STANDARD,	/*!< also what the other files saved at the end of a run need */
+    STATS_FULL		/*!< all of them, by agent and by group too */
+};
+
+#define OUTPUT_WINDOW_DAYS	3   /*!< \def OUTPUT_WINDOW_DAYS the days a long_output row is calculated from (see Utils::calcOutputRow()) */
+
 /**
  * \struct ResValues
  * Contains steepnessFactor and scalingFactor of resources.
@@ -45,6 +64,22 @@ struct ResValues {
     double scalingFactor;
 };
 
+/**
+ * \struct RunBranch
+ * A counterfactual branch of the run (see --branch-res and --branch-agent):
+ * the removal it makes instead of the run's own, and where its results go.
+ */
+struct RunBranch {
+    bool   removeRes;
+    int    resToRemove;
+    int    removeResDay;
+    bool   eliminateReserves;
+    bool   removeAgent;
+    int    agentToRemove;
+    int    removeAgentDay;
+    string saveFolder;
+};
+
 class Agent;
 class Device;
 class ResourceMarketplace;
@@ -53,21 +88,13 @@ class ProductionStats;
 class TradeStats;
 class OtherStats;
 class DeviceMarketplace;
+class ThreadPool;
 
 
 
 class Globals
 {
 public:
-    /**
-     * TO memorize the used sub-set values of marginal utilities.
-     * Used in agent::barterUtility.
-     * Map a pair of <int, int> to a double.
-     * Indexed by NUM_AGENT_GROUPS.
-     * Each group of agents has its own memoMU.
-     */
-    vector< map<pair<int,int>,double> > memoMUs;
-
     /**
      * Values for command-line options.
      */
@@ -83,6 +110,7 @@ public:
     string simTitle;                // *** initialized in parse_args()
     bool   randomSeedSet;           // *** initialized in parse_args()
     int    randomSeed;              // *** initialized in parse_args()
+    uint64_t streamSeed;            // *** initialized in initGlobalStructures(); the key of the per-agent RandomStreams
     bool   removeAgentMidRun;       // *** initialized in parse_args()
     int    removeAgentId;           // *** initialized in parse_args()
     int    removeAgentDay;          // *** initialized in parse_args()
@@ -97,6 +125,21 @@ public:
     bool   saveExchangeRateData;    // *** initialized in parse_args()
     bool   graphSet;                // *** initialized in parse_args()
     bool   noRunSet;                // *** initialized in parse_args()
+    int    NUM_THREADS;             // *** initialized in parse_args()
+    bool   parallelTradesSet;       // *** initialized in parse_args()
+    bool   legacyPairingSet;        // *** initialized in parse_args()
+    vector<int> branchResArgs;      // *** initialized in parse_args(); the -r args of each branch
+    vector<int> branchAgentArgs;    // *** initialized in parse_args(); the -a args of each branch
+    bool   branchForkSet;           // *** initialized in parse_args()
+    int    numRuns;                 // *** initialized in parse_args()
+    int    runJobs;                 // *** initialized in parse_args()
+    bool   sweepSet;                // *** initialized in parse_args()
+    bool   binaryOutputSet;         // *** initialized in parse_args()
+    stats_profile_t statsProfileArg; // *** initialized in parse_args()
+    bool   profileSet;              // *** initialized in parse_args()
+    string sweepFilename;           // *** initialized in parse_args()
+    string logFileName;             // *** initialized in parse_args()
+    string pointConfigFilename;     // *** initialized in constructor; set in main() for each point of a sweep
 
     
     
@@ -180,7 +223,13 @@ public:
     string SIM_NAME;               // *** initialized in constructor and setAdvancedOptions() and reinitialize()
     string SIM_SAVE_FOLDER;        // *** initialized in setAdvancedOptions() and reinitialize()
     bool   SAVE_TRADES;            // *** initialized in setAdvancedOptions()
-    bool   PARALLEL_TRADES;        // *** initialized in constructor
+    bool   PARALLEL_TRADES;        // *** initialized in constructor and setAdvancedOptions()
+    bool   BINARY_OUTPUT;          // *** initialized in constructor and setAdvancedOptions()
+    stats_profile_t STATS_PROFILE; // *** initialized in constructor and setAdvancedOptions()
+    bool   PROFILE;                // *** initialized in constructor and setAdvancedOptions()
+    vector<RunBranch> BRANCHES;    // *** initialized in setAdvancedOptions(); cleared by applyBranch()
+    int    BRANCH_DAY;             // *** initialized in constructor and setAdvancedOptions(); the day the branches start after, -99 if none
+    bool   BRANCH_FORK;            // *** initialized in setAdvancedOptions()
 
     /* "Global" constants that are data structures and computed
        at start-up time. */
@@ -208,11 +257,15 @@ public:
     ProductionStats *productionStats;       // *** initialized in setGlobalStats()
     TradeStats *tradeStats;                 // *** initialized in setGlobalStats()
     OtherStats *otherStats;                 // *** initialized in setGlobalStats()
+    ThreadPool *threadPool;                 // *** initialized in initGlobalStructures()
+    int runIndex;       // *** the run of the batch (see --runs), from 0; initialized in constructor and reinitialize()
+    string SWEEP_FOLDER;    // *** the folder of the consolidated results of a sweep, "" if not sweeping; initialized in constructor and main()
 
     int currentDay;     // *** the number of current day; initialized in main()
 
     int activeAgents;   // *** initialized in initializeAgents()
     vector<Agent *> agent;  // *** initialized in initializeAgents()
+    AgentState agentState;  // *** initialized in freeRunState(), before the agents are made
 
     // *** initialized in initGlobalStructures()
     vector<vector<Device *> > discoveredDevices;  // indexed by device_name_t and then deviceIdx.
@@ -239,6 +292,10 @@ public:
     void initializeAgents();
     void setAdvancedOptions();
     void perRunInitialization();
+    void reinitialize(int run, string title);
+    void applyBranch(const RunBranch &branch);
+    void freeRunState();
+    void clearRunState();
     void setGlobalMarketPlaces();
     void setGlobalStats();
     void printConfig();
@@ -256,6 +313,8 @@ public:
     int random_int_inclusive(int lower, int upper);
     int random_choice(vector<int> &vec);
     int random_binomial(int n, double p);
+    void saveRandomState(ostream &out);
+    void loadRandomState(istream &in);
     int getNumDeviceTypes() {return NUM_DEVICE_TYPES;};
     int getNumResGatherDev() {return NUM_RESOURCE_GATHERING_DEVICES;};
     void createDirectory(string path);
@@ -0,0 +1,190 @@
+/**
+ * The history module includes the definition of the DailyHistory class
+ * template, which keeps a value for each agent (each row) on each day of a
+ * run, for a few blocks (the resources, the device types), in one array
+ * sized for NUM_DAYS days up front.  The array is laid out
+ * [block][day][row]: the values of a day are a contiguous row, filled in at
+ * once by the daily update and read at once by the statistics over all the
+ * agents of a day, and the values of one agent over the days are read
+ * through a Series that steps over the rows.
+ *
+ * A rolling history keeps only the last few days, for the stats that are
+ * only read for the days around the current one: it is sized for those
+ * days, and each new day takes the place of the oldest.
+ */
+
+#ifndef _SOC_HISTORY_H_
+#define _SOC_HISTORY_H_
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include "binaryio.h"
+
+using namespace std;
+
+template <class T>
+class DailyHistory
+{
+private:
+    int blocks;
+    int rows;               //!< the number of values of each day in a block
+    int capacity;           //!< the number of days there is room for
+    bool rolling;           //!< keep only the last capacity days
+    int days;               //!< the number of days recorded
+    vector<T> values;       //!< [block][day][row]
+
+    int slot(int day) const { return rolling ? day % capacity : day; }
+    int offset(int day, int block) const { return (block * capacity + slot(day)) * rows; }
+
+    /*
+     * Make room for more days than NUM_DAYS (never needed by a run, which
+     * does not outlast the days it was sized for).
+     */
+    void grow(int newCapacity)
+    {
+        vector<T> moved(blocks * newCapacity * rows, T());
+        for (int block = 0; block < blocks; block++) {
+            copy(values.begin() + offset(0, block), values.begin() + offset(days, block),
+                 moved.begin() + block * newCapacity * rows);
+        }
+        values.swap(moved);
+        capacity = newCapacity;
+    }
+
+public:
+    /**
+     * The values of one row over the days recorded, one row apart in the
+     * array.
+     */
+    class Series
+    {
+    private:
+        const T *first;
+        int stride;
+        int length;
+
+    public:
+        Series(const T *first, int stride, int length) : first(first), stride(stride), length(length) {}
+        int size() const { return length; }
+        const T &operator[](int day) const { return first[day * stride]; }
+    };
+
+    /**
+     * Constructor.
+     * \param blocks the number of blocks
+     * \param rows the number of values of each day in a block
+     * \param capacity the number of days to make room for
+     * \param rolling true to keep only the last capacity days (at least 1)
+     */
+    DailyHistory(int blocks = 0, int rows = 0, int capacity = 0, bool rolling = false) :
+        blocks(blocks), rows(rows), capacity(capacity), rolling(rolling), days(0),
+        values(blocks * capacity * rows, T())
+    {
+    }
+
+    /**
+     * \return the number of days recorded, including those a rolling
+     * history no longer keeps.
+     */
+    int numDays() const { return days; }
+    int numBlocks() const { return blocks; }
+    int numRows() const { return rows; }
+
+    /**
+     * Start a new day, with all its values 0.
+     */
+    void newDay()
+    {
+        if (rolling) {
+            days++;
+            for (int block = 0; block < blocks; block++) {
+                fill(todayRow(block), todayRow(block) + rows, T());
+            }
+            return;
+        }
+        if (days == capacity) {
+            grow(max(2 * capacity, 1));
+        }
+        days++;
+    }
+
+    /**
+     * \return the row of the values of the last day started, to fill in.
+     */
+    T *todayRow(int block = 0) { return values.data() + offset(days - 1, block); }
+
+    /**
+     * \return the row of the values of a day recorded (and kept).
+     */
+    const T *dayRow(int day, int block = 0) const { return values.data() + offset(day, block); }
+
+    /**
+     * \return one value of a day recorded (and kept).
+     */
+    const T &at(int day, int row = 0, int block = 0) const { return dayRow(day, block)[row]; }
+
+    /**
+     * \return the values of one row over the days recorded, of a history
+     * that is not rolling.
+     */
+    Series series(int row, int block = 0) const
+    {
+        return Series(values.data() + offset(0, block) + row, rows, days);
+    }
+
+    /**
+     * Write the days recorded and kept to a day status file.
+     */
+    void saveState(ostream &out) const
+    {
+        int kept = rolling ? min(days, capacity) : days;
+        writeBinary(out, blocks);
+        writeBinary(out, rows);
+        writeBinary(out, days);
+        writeBinary(out, kept);
+        for (int block = 0; block < blocks; block++) {
+            for (int day = days - kept; day < days; day++) {
+                const T *value = dayRow(day, block);
+                for (int i = 0; i < rows; i++) {
+                    writeBinary(out, value[i]);
+                }
+            }
+        }
+    }
+
+    /**
+     * Read back the days written by saveState().  A history that is not
+     * rolling keeps room for at least as many days as before; a rolling
+     * one keeps its last capacity days.
+     */
+    void loadState(istream &in)
+    {
+        int savedBlocks = blocks, savedRows = rows, savedDays = 0, kept = 0;
+        readBinary(in, savedBlocks);
+        readBinary(in, savedRows);
+        readBinary(in, savedDays);
+        readBinary(in, kept);
+        if (! in) {
+            return;
+        }
+        blocks = savedBlocks;
+        rows = savedRows;
+        if (! rolling) {
+            capacity = max(capacity, savedDays);
+        }
+        days = savedDays;
+        values.assign(blocks * capacity * rows, T());
+        for (int block = 0; block < blocks && in; block++) {
+            for (int day = days - kept; day < days && in; day++) {
+                T *value = values.data() + offset(day, block);
+                for (int i = 0; i < rows && in; i++) {
+                    readBinary(in, value[i]);
+                }
+            }
+        }
+    }
+};
+
+
+#endif
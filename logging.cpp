@@ -0,0 +1,80 @@
+/**
+ * The output of the log messages (see logging.h).
+ */
+#include <fstream>
+#include <ctime>
+#include <boost/thread/mutex.hpp>
+#include "logging.h"
+
+static boost::mutex outputMutex;
+static std::ofstream logFile;
+static char logFileBuffer[1 << 16];
+static bool toLogFile = false;
+
+/**
+ * Constructor: start the message with the time and where it comes from.
+ * \param funcName the function logging the message
+ * \param lineNum the line of the LOG()
+ * \param level the level of the message
+ */
+Log::Log(const char *funcName, int lineNum, int level)
+{
+    char t[100];
+    time_t rawtime;
+    struct tm tim;
+    time(&rawtime);
+    localtime_r(&rawtime, &tim);
+    strftime(t, 100, "%c", &tim);
+    msg << t << ": " << funcName << " [" << lineNum << "] " << "Log(" << level << "): ";
+}
+
+/**
+ * Write the message out.
+ */
+Log::~Log()
+{
+    boost::mutex::scoped_lock lock(outputMutex);
+    if (toLogFile) {
+        logFile << msg.str() << '\n';
+    } else {
+        std::cout << msg.str() << std::endl;
+    }
+}
+
+/**
+ * Send the messages to a file instead of cout.  The file is only written
+ * when its buffer is full, on flush() and when the program exits.
+ * \param path the file, which is truncated
+ * \return false (after telling why on cerr) if the file cannot be opened.
+ */
+bool Log::openFile(const std::string &path)
+{
+    boost::mutex::scoped_lock lock(outputMutex);
+    if (logFile.is_open()) {
+        logFile.close();
+    }
+    logFile.clear();
+    logFile.rdbuf()->pubsetbuf(logFileBuffer, sizeof(logFileBuffer));
+    logFile.open(path.c_str());
+    if (! logFile) {
+        std::cerr << "Could not open the log file " << path << std::endl;
+        toLogFile = false;
+        return false;
+    }
+    toLogFile = true;
+    return true;
+}
+
+/**
+ * Write out the buffered messages.  Call before fork(), so that a child
+ * process does not write them again.
+ */
+void Log::flush()
+{
+    boost::mutex::scoped_lock lock(outputMutex);
+    if (toLogFile) {
+        logFile.flush();
+    } else {
+        std::cout.flush();
+    }
+}
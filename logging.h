@@ -2,49 +2,53 @@
 #define _SOC_LOGGING_
 
 #include <iostream>
-#include <ctime>
+#include <sstream>
+#include <string>
 #include "globals.h"
 
+/*
+ * Messages above this level are compiled out: LOG(l) with l greater than
+ * LOG_MAX_LEVEL is a constant false test that the compiler drops, so its
+ * arguments are never evaluated.  Build with -DLOG_MAX_LEVEL=0 in
+ * CXXFLAGS to strip all logging from the program.
+ */
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL 5
+#endif
 
 /*
- * TODO: change this so we can go to an ostream that isn't cout.
+ * A message is built up in msg and written out as a whole when the Log
+ * object goes away, so that messages from agents running on different
+ * threads do not get mixed up.  Messages go to cout, or to the buffered
+ * file given to openFile() (see --log-file).  A Log object is only made
+ * once LOG() has decided that its level is shown.
  */
 class Log
 {
 private:
-    int msgLevel;
+    std::ostringstream msg;
+
 public:
-    Log(const std::string &funcName, int lineNum, int level) :
-        msgLevel(level)
-    {
-        if (msgLevel > glob.verboseLevel) { return; }
-        char t[100];
-        time_t rawtime;
-        struct tm *tim;
-        time(&rawtime);
-        tim = localtime(&rawtime);
-        strftime(t, 100, "%c", tim);
-        std::cout << t << ": " << funcName << " [" << lineNum << "] " << "Log(" << level << "): ";
-    }
+    Log(const char *funcName, int lineNum, int level);
+    ~Log();
 
     template <class T>
     Log &operator<<(const T &v)
     {
-        if (msgLevel <= glob.verboseLevel) {
-            std::cout << v;
-        }
+        msg << v;
         return *this;
     }
 
-    ~Log()
-    {
-        if (msgLevel > glob.verboseLevel) { return; }
-        std::cout << std::endl;
-    }
+    static bool openFile(const std::string &path);
+    static void flush();
 };
 
-// Call this line to generate a log message at level l.
-#define LOG(l) Log(__FUNCTION__, __LINE__, l)
+// True if a message at level l is shown.
+#define LOG_ENABLED(l) ((l) <= LOG_MAX_LEVEL && (l) <= glob.verboseLevel)
+
+// Call this line to generate a log message at level l.  Nothing after
+// LOG(l) is evaluated if the level is not shown.
+#define LOG(l) if (! LOG_ENABLED(l)) ; else Log(__FUNCTION__, __LINE__, l)
 
 
 #endif
@@ -4,37 +4,85 @@
  * Can also use -p, -z, ... to specify the options. See options.cpp for more information on te options.
  */
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sstream>
+#include <cstdio>
+#include <fstream>
+#include <boost/foreach.hpp>
 #include "globals.h"
 #include "utils.h"
 #include "options.h"
 #include "logging.h"
 #include "statstracker.h"
+#include "threadpool.h"
+#include "profiler.h"
+#include "sweep.h"
+#include "ran.h"
 
 Globals glob;
 Utils util;
+Profiler prof;
 
-void runSimulation()
-{
-    glob.perRunInitialization();
+/**
+ * A branch that still has to be run from the shared snapshot, after the
+ * run itself is done.
+ */
+static vector<RunBranch> pendingBranches;
+static string branchSnapshot;
+static vector<pid_t> branchPids;
+static bool inBranchProcess = false;
 
-    glob.startTimer();
+void startBranches(int day);
+
+/**
+ * With PROFILE, start writing the profile of the run (see profiler.h).
+ */
+void startProfile()
+{
+    if (glob.PROFILE) {
+        prof.startRun(glob.SIM_SAVE_FOLDER + "/profile_" + glob.simTitle + ".csv");
+    }
+}
 
-    for (int i = glob.START_DAY; i < glob.NUM_DAYS; i++) {
+/**
+ * Run the days from firstDay to the end of the simulation.
+ */
+void runDays(int firstDay)
+{
+    for (int i = firstDay; i < glob.NUM_DAYS; i++) {
         LOG(1) << "Day " << i+1 << " of " << glob.NUM_DAYS;
         glob.currentDay = i;
+        prof.phase(TRADE_DEVICES_PHASE);
         util.agentsTradeDevices();
+        prof.phase(PRODUCE_DEVICES_PHASE);
         util.agentsProduceDevices();
+        prof.phase(TRADE_PHASE);
         util.agentsTrade();
+        prof.phase(WORK_PHASE);
         util.agentsWork();
+        prof.phase(TRADE_PHASE);
         util.agentsTrade();
+        prof.phase(INVENT_PHASE);
         util.agentsInvent();
+        prof.phase(END_DAY_PHASE);
         util.endDay();
+        prof.phase(DAY_ANALYSIS_PHASE);
         util.dayAnalysis(i);
+        prof.phase(END_DAY_DECAY_PHASE);
         util.endDayDecay();
+        prof.endDay(i);
+        if (i == glob.BRANCH_DAY) {
+            startBranches(i);
+        }
         util.removeOrSave(i);
     }
+}
 
+void finishRun()
+{
     glob.endTimer();
+    prof.endRun();
 
     LOG(1) << "Ending simulation";
     util.endSim();
@@ -42,6 +90,234 @@ void runSimulation()
     cout << "The total number of seconds is " << (glob.endTime - glob.startTime) << endl;
 }
 
+/**
+ * Start the branches of the run at the end of the given day, before its
+ * removals.  With BRANCH_FORK each branch is a child process that shares
+ * the memory of the run so far; otherwise (or if fork() fails) the state
+ * of the run is kept as a day status and the branches are run from it
+ * one after the other once the run is done.
+ */
+void startBranches(int day)
+{
+    vector<RunBranch> branches = glob.BRANCHES;
+    BOOST_FOREACH(RunBranch &branch, branches) {
+        if (glob.BRANCH_FORK) {
+            Log::flush();
+            pid_t pid = fork();
+            if (pid == 0) {
+                // worker threads do not survive fork(): give the branch its own
+                glob.threadPool = new ThreadPool(glob.NUM_THREADS);
+                pendingBranches.clear();
+                branchPids.clear();
+                inBranchProcess = true;
+                glob.applyBranch(branch);
+                startProfile();
+                return;
+            }
+            if (pid > 0) {
+                branchPids.push_back(pid);
+                continue;
+            }
+            cerr << "Could not fork the branch saved in " << branch.saveFolder <<
+                ", running it after the run instead" << endl;
+        }
+        if (branchSnapshot.empty()) {
+            ostringstream out;
+            util.writeDayStatus(out, day);
+            branchSnapshot = out.str();
+        }
+        pendingBranches.push_back(branch);
+    }
+}
+
+/**
+ * Run the branches left by startBranches() from the snapshot.
+ */
+void runPendingBranches()
+{
+    int day = glob.BRANCH_DAY;
+    BOOST_FOREACH(RunBranch &branch, pendingBranches) {
+        glob.applyBranch(branch);
+        glob.clearRunState();
+        istringstream in(branchSnapshot);
+        if (! util.readDayStatus(in, day, "the branch snapshot")) {
+            cerr << "Could not restore the state of day " << day << " for a branch" << endl;
+            exit(1);
+        }
+        glob.startTimer();
+        startProfile();
+        glob.currentDay = day;
+        util.removeOrSave(day);
+        runDays(day + 1);
+        finishRun();
+    }
+    pendingBranches.clear();
+    branchSnapshot.clear();
+}
+
+void runSimulation()
+{
+    glob.perRunInitialization();
+
+    if (! glob.BRANCHES.empty() &&
+        (glob.BRANCH_DAY < glob.START_DAY || glob.BRANCH_DAY >= glob.NUM_DAYS)) {
+        cerr << "The branches start on day " << glob.BRANCH_DAY <<
+            ", which is not a day of this run: no branches will be run" << endl;
+    }
+
+    glob.startTimer();
+    startProfile();
+    runDays(glob.START_DAY);
+    finishRun();
+
+    if (inBranchProcess) {
+        exit(0);
+    }
+    runPendingBranches();
+    BOOST_FOREACH(pid_t pid, branchPids) {
+        int status;
+        waitpid(pid, &status, 0);
+    }
+    branchPids.clear();
+}
+
+/**
+ * \return the run number (see -t) of the given run of the batch: the runs
+ * of a batch are numbered 001, 002, ... or on from the -t run number.
+ */
+string runTitle(string firstTitle, int run)
+{
+    if (glob.numRuns == 1) {
+        return firstTitle;
+    }
+    int first = (firstTitle == "000") ? 1 : atoi(firstTitle.c_str());
+    char title[16];
+    sprintf(title, "%03d", first + run);
+    return title;
+}
+
+/**
+ * The number of runs being made in forked processes (see runBatch()).
+ */
+static int runningJobs = 0;
+
+/**
+ * Wait until fewer than maxJobs forked runs are still going.
+ */
+void waitForRuns(int maxJobs)
+{
+    while (runningJobs >= maxJobs && runningJobs > 0) {
+        int status;
+        wait(&status);
+        runningJobs--;
+    }
+}
+
+/**
+ * Make the glob.numRuns runs of the config.  The config file is parsed
+ * once; each run only reseeds and rebuilds the agents (see
+ * Globals::reinitialize()).  With glob.runJobs > 1, up to that many runs
+ * are made at the same time in forked processes; waitForRuns(1) waits
+ * for the last of them.
+ */
+void runBatch()
+{
+    string firstTitle = glob.simTitle;
+    for (int run = 0; run < glob.numRuns; run++) {
+        if (glob.runJobs == 1) {
+            glob.reinitialize(run, runTitle(firstTitle, run));
+            runSimulation();
+            continue;
+        }
+        waitForRuns(glob.runJobs);
+        Log::flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            // worker threads do not survive fork(): give the run its own
+            glob.threadPool = new ThreadPool(glob.NUM_THREADS);
+            glob.reinitialize(run, runTitle(firstTitle, run));
+            runSimulation();
+            exit(0);
+        }
+        if (pid > 0) {
+            runningJobs++;
+        } else {
+            cerr << "Could not fork run " << run + 1 << ", making it in this process instead" << endl;
+            glob.reinitialize(run, runTitle(firstTitle, run));
+            runSimulation();
+        }
+    }
+}
+
+/**
+ * Make glob.numRuns runs at each point of the sweep in glob.sweepFilename.
+ * Each point gets its own config file (the -p one with the swept options
+ * changed), save folder and UniqueKey, <-d key>_pNNN; the long_output rows
+ * of all the runs go to one file in the -s folder, next to sweep_points.csv
+ * which gives the values of the swept options for each UniqueKey.  With
+ * -S, every point uses the same seeds, so the points differ only by their
+ * options.
+ * \param argc the number of arguments, parsed again for each point
+ * \param argv the arguments
+ */
+void runSweep(int argc, char *argv[])
+{
+    string baseConfig = glob.configFilename;
+    string sweepFolder = glob.saveFileFolder;
+    string uniqueKey = glob.UniqueKey;
+
+    Sweep sweep;
+    uint64_t seed = glob.randomSeedSet ? (uint64_t) glob.randomSeed : GetSeed();
+    if (! sweep.load(glob.sweepFilename, seed)) {
+        cerr << "Error in the sweep spec: exiting now." << endl;
+        exit(1);
+    }
+    glob.createDirectory(sweepFolder);
+    glob.createDirectory(sweepFolder + "/sweepConfigs");
+
+    ofstream pointsFile((sweepFolder + "/sweep_points.csv").c_str());
+    pointsFile << "UniqueKey";
+    BOOST_FOREACH(const string &key, sweep.getKeys()) {
+        pointsFile << "," << key;
+    }
+    pointsFile << "\n";
+
+    for (int point = 0; point < sweep.numPoints(); point++) {
+        char pointName[16];
+        sprintf(pointName, "p%03d", point + 1);
+        string pointConfig = sweepFolder + "/sweepConfigs/" + glob.configName + "_" + pointName + ".conf";
+        if (! sweep.writePointConfig(point, baseConfig, pointConfig)) {
+            exit(1);
+        }
+        glob.pointConfigFilename = pointConfig;
+        if (parse_args(argc, argv) < 0) {
+            cerr << "Error in the config of sweep point " << pointName << ": exiting now." << endl;
+            exit(1);
+        }
+        glob.saveFileFolder = sweepFolder + '/' + pointName;
+        glob.UniqueKey = (uniqueKey == "none") ? string(pointName) : uniqueKey + "_" + pointName;
+        glob.SWEEP_FOLDER = sweepFolder;
+
+        glob.simTitle = runTitle(glob.simTitle, 0);
+        glob.initGlobalStructures();
+        glob.setAdvancedOptions();
+
+        pointsFile << glob.UniqueKey;
+        BOOST_FOREACH(const string &value, sweep.getPoint(point)) {
+            pointsFile << "," << value;
+        }
+        pointsFile << "\n";
+
+        if (glob.noRunSet) {
+            glob.printConfig();
+            continue;
+        }
+        util.saveBatchInfo();
+        pointsFile.flush();
+        runBatch();
+    }
+}
+
 
 int main(int argc, char *argv[]){
     glob = Globals();
@@ -51,7 +327,17 @@ int main(int argc, char *argv[]){
         cerr << "Error in parse_args: exiting now." << endl;
     	return 0;
     }
+    if (glob.logFileName != "" && ! Log::openFile(glob.logFileName)) {
+        return 1;
+    }
+
+    if (glob.sweepSet) {
+        runSweep(argc, argv);
+        waitForRuns(1);
+        return 0;
+    }
 
+    glob.simTitle = runTitle(glob.simTitle, 0);
     glob.initGlobalStructures();
     glob.setAdvancedOptions();
 
@@ -60,5 +346,6 @@ int main(int argc, char *argv[]){
         exit(0);
     }
 
-    runSimulation();
+    runBatch();
+    waitForRuns(1);
 }
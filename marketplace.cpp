@@ -31,10 +31,13 @@
 #include <cassert>
 #include <boost/foreach.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/bind.hpp>
 #include "marketplace.h"
 #include "agent.h"
 #include "statstracker.h"
+#include "threadpool.h"
 #include "logging.h"
+#include "profiler.h"
 
 
 /**
@@ -49,14 +52,24 @@ void ResourceMarketplace::tradeResources()
 
 
 /**
- * Two agents are randomly chosen to be a trading pair.
+ * Used below for running the trade of one pair on the thread pool.
  */
-void ResourceMarketplace::genPairs()
+static void pairTradeAt(vector<ResourcePair> *pairs, int pairIndex)
+{
+    (*pairs)[pairIndex].pairTrade();
+}
+
+/**
+ * The pairing of older versions: the agents are kept in a list, and each
+ * pick walks the list to a random position, so a round costs O(n^2).
+ * Kept (--legacy-pairing) because it uses the random numbers the same
+ * way the old versions did, so old seeds give the same pairs.
+ */
+static void genLegacyPairs(vector<ResourcePair> &pairs)
 {
     list<Agent *> agentList;	// use a doubly-linked list that supports quick deletion from in the middle.
     agentList.assign(glob.agent.begin(), glob.agent.end());
 
-    vector<ResourcePair> pairs;	
     while (agentList.size() > 1) {
 #ifdef DONT_RANDOMIZE
         int loc = 0;
@@ -76,9 +89,70 @@ void ResourceMarketplace::genPairs()
     }
 
     assert( (agentList.size() == 0) || (agentList.size() == 1));
+}
 
-    BOOST_FOREACH(ResourcePair pair, pairs) {
-        pair.pairTrade();
+/**
+ * Removes the agent at loc from agentList in O(1) by moving the last
+ * agent into its place, and returns it.
+ */
+static Agent *takeAgentAt(vector<Agent *> &agentList, int loc)
+{
+    Agent *taken = agentList[loc];
+    agentList[loc] = agentList.back();
+    agentList.pop_back();
+    return taken;
+}
+
+/**
+ * Each agent is picked uniformly at random from the agents not paired
+ * yet, as in genLegacyPairs(), so the pairs have the same distribution;
+ * only the order of the unpaired agents differs, which makes every pick
+ * O(1).
+ */
+static void genShuffledPairs(vector<ResourcePair> &pairs)
+{
+    vector<Agent *> agentList(glob.agent.begin(), glob.agent.end());
+    pairs.reserve(agentList.size() / 2);
+
+    while (agentList.size() > 1) {
+#ifdef DONT_RANDOMIZE
+        int loc = 0;
+#else
+        int loc = glob.random_int(0, agentList.size());
+#endif
+        Agent *firstAgent = takeAgentAt(agentList, loc);
+        loc = glob.random_int(0, agentList.size());
+        Agent *secondAgent = takeAgentAt(agentList, loc);
+        pairs.push_back(ResourcePair(firstAgent, secondAgent));
+    }
+
+    assert( (agentList.size() == 0) || (agentList.size() == 1));
+}
+
+/**
+ * Two agents are randomly chosen to be a trading pair.
+ * With PARALLEL_TRADES, the pairs of the round trade concurrently: no
+ * agent is in two pairs, and a pair only changes its own two agents, so
+ * the outcome is the same as trading them one after the other.
+ */
+void ResourceMarketplace::genPairs()
+{
+    vector<ResourcePair> pairs;
+    if (glob.legacyPairingSet) {
+        genLegacyPairs(pairs);
+    } else {
+        genShuffledPairs(pairs);
+    }
+
+    if (glob.PARALLEL_TRADES) {
+        glob.threadPool->parallelFor(pairs.size(), boost::bind(pairTradeAt, &pairs, _1));
+        if (glob.SAVE_TRADES) {
+            glob.tradeStats->mergeThreadExchanges();
+        }
+    } else {
+        BOOST_FOREACH(ResourcePair pair, pairs) {
+            pair.pairTrade();
+        }
     }
 }
 
@@ -117,6 +191,7 @@ bool sortpairs(const pair<double, int>& i, const pair<double, int>& j)
  */
 void ResourcePair::pairTrade()
 {
+    prof.count(PAIR_TRADE_COUNT);
     if (! (agentA->inSimulation && agentB->inSimulation)) {
         return;
     }
@@ -437,12 +512,12 @@ void ResourcePair::writeTradeData()
     double avgHeldResB = (double) totalHeldResB / (double) glob.NUM_AGENTS;
 
     /* Calculate the MU that any agent (I use agentA) would place on holding that many units of Resources A & B. */
-    double MUResA = agentA->resProp[aPick].marginalUtilities[avgHeldResA];
-    double MUResB = agentA->resProp[bPick].marginalUtilities[avgHeldResB];
+    double MUResA = agentA->resProp[aPick].getMarginalUtilities()[avgHeldResA];
+    double MUResB = agentA->resProp[bPick].getMarginalUtilities()[avgHeldResB];
 
     /* Calculate the ratio of MUResA/MUResB for agentA and B */
-    double MUResAAgentA = agentA->resProp[aPick].marginalUtilities[agentA->resProp[aPick].getHeld()];
-    double MUResBAgentA = agentA->resProp[bPick].marginalUtilities[agentA->resProp[bPick].getHeld()];
+    double MUResAAgentA = agentA->resProp[aPick].getMarginalUtilities()[agentA->resProp[aPick].getHeld()];
+    double MUResBAgentA = agentA->resProp[bPick].getMarginalUtilities()[agentA->resProp[bPick].getHeld()];
     double MURatioAgentA = MUResAAgentA / MUResBAgentA;
 
     /*
@@ -451,8 +526,8 @@ void ResourcePair::writeTradeData()
      * the two agents meet (Epstein & Axtell, p. 103). It seems to be very close, but
      * not the same as the TradeRatio used above.
      */
-    double MUResAAgentB = agentB->resProp[aPick].marginalUtilities[agentB->resProp[aPick].getHeld()];
-    double MUResBAgentB = agentB->resProp[bPick].marginalUtilities[agentB->resProp[bPick].getHeld()];
+    double MUResAAgentB = agentB->resProp[aPick].getMarginalUtilities()[agentB->resProp[aPick].getHeld()];
+    double MUResBAgentB = agentB->resProp[bPick].getMarginalUtilities()[agentB->resProp[bPick].getHeld()];
     double MURatioAgentB = MUResAAgentB / MUResBAgentB;
     double myTradeRatio = sqrt(MURatioAgentA*MURatioAgentB);
 
@@ -494,6 +569,7 @@ void ResourcePair::writeTradeData()
  */
 void ResourcePair::makeTrade()
 {
+    prof.count(MAKE_TRADE_COUNT);
     LOG(3) << "Agent " << agentA->name << " is about to gain " <<
         agentA->barterUtility(aPick, numAPicked) << " and lose " <<
         agentA->barterUtility(bPick, - numBPicked) << " by selling " <<
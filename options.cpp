@@ -22,6 +22,75 @@
 using namespace std;
 namespace po = boost::program_options;
 
+/**
+ * \return the options that can be set in the config file, bound to the
+ * fields of glob they set.
+ */
+static po::options_description configFileOptions()
+{
+    po::options_description cfgFileOpts("Config file options");
+    cfgFileOpts.add_options()
+        ("NUM_AGENTS",      po::value<int>(&glob.NUM_AGENTS), "number of agents in this simulation")
+        ("START_DAY",       po::value<int>(&glob.START_DAY),  "the day to start on when restarting a simulation")
+        ("DAY_LENGTH",      po::value<int>(&glob.DAY_LENGTH), "the length of a day")
+        ("NUM_DAYS",        po::value<int>(&glob.NUM_DAYS), "number of days in the simulation")
+        ("NUM_RESOURCES",   po::value<int>(&glob.NUM_RESOURCES), "number of resources in the simulation")
+        ("NUM_AGENT_GROUPS",       po::value<int>(&glob.NUM_AGENT_GROUPS), "number of types of agents in the simulation")
+        ("RES_TRADE_ROUNDS", po::value<int>(&glob.RES_TRADE_ROUNDS), "number of resource trading rounds")
+        ("RES_TRADE_ATTEMPTS", po::value<int>(&glob.RES_TRADE_ATTEMPTS), "number of resource trading attempts")
+        ("DEVICE_TRADE_ROUNDS", po::value<int>(&glob.DEVICE_TRADE_ROUNDS), "number of device trading rounds")
+        ("DEVICE_TRADE_ATTEMPTS", po::value<int>(&glob.DEVICE_TRADE_ATTEMPTS), "number of device trading attempts")
+        ("MENU_SIZE",       po::value<int>(&glob.MENU_SIZE), "Menu size: fix this!")
+        ("DEVICE_TRADE_MEMORY_LENGTH", po::value<int>(&glob.DEVICE_TRADE_MEMORY_LENGTH), "HELP")
+        ("DEVICE_PRODUCTION_MEMORY_LENGTH", po::value<int>(&glob.DEVICE_PRODUCTION_MEMORY_LENGTH), "HELP")
+	    ("MIN_DEVICE_FOR_DEV_DEVICE_CONSIDERATION", po::value<int>(&glob.MIN_DEVICE_FOR_DEV_DEVICE_CONSIDERATION), "HELP")
+	    ("MIN_RES_HELD_FOR_DEVICE_CONSIDERATION", po::value<int>(&glob.MIN_RES_HELD_FOR_DEVICE_CONSIDERATION), "HELP")
+        ("DAILY_EXP_PENALTY", po::value<double>(&glob.DAILY_EXP_PENALTY), "HELP")
+        ("PRODUCTION_EPSILON", po::value<double>(&glob.PRODUCTION_EPSILON), "HELP")
+        ("RESOURCES_IN_TOOL",  po::value<int>(&glob.RESOURCES_IN_TOOL), "number of resources needed to make a tool (?)")
+        ("MAX_RES_EXPERIENCE",  po::value<double>(&glob.MAX_RES_EXPERIENCE), "HELP")
+        ("INVENTOR_DEVICE_EXPERIENCE",  po::value<double>(&glob.INVENTOR_DEVICE_EXPERIENCE), "HELP")
+        ("NUM_DEVICE_COMPONENTS",  po::value<int>(&glob.NUM_DEVICE_COMPONENTS), "HELP")
+        ("MAX_DEVICE_EXPERIENCE",  po::value<double>(&glob.MAX_DEVICE_EXPERIENCE), "HELP")
+        ("DAILY_DEVICE_DECAY",  po::value<double>(&glob.DAILY_DEVICE_DECAY), "HELP")
+        ("MIN_HELD_DEVICE_EXPERIENCE", po::value<double>(&glob.MIN_HELD_DEVICE_EXPERIENCE), "HELP")
+        ("MAX_RES_EFFORT", po::value<double>(&glob.MAX_RES_EFFORT), "HELP")
+        ("MIN_RES_EFFORT", po::value<double>(&glob.MIN_RES_EFFORT), "HELP")
+        ("MAX_DEVICE_EFFORT", po::value<double>(&glob.MAX_DEVICE_EFFORT), "HELP")
+        ("MIN_DEVICE_EFFORT", po::value<double>(&glob.MIN_DEVICE_EFFORT), "HELP")
+        ("MIN_RES_UTIL", po::value<double>(&glob.MIN_RES_UTIL), "HELP")
+        ("TRADE_EPSILON", po::value<double>(&glob.TRADE_EPSILON), "HELP")
+        ("TOOL_PROBABILITY_FACTOR", po::value<double>(&glob.TOOL_PROBABILITY_FACTOR), "HELP")
+        ("DEVICE_PROBABILITY_FACTOR", po::value<double>(&glob.DEVICE_PROBABILITY_FACTOR), "HELP")
+        ("TOOL_FACTOR", po::value<double>(&glob.TOOL_FACTOR), "HELP")
+        ("TOOL_LIFETIME", po::value<double>(&glob.TOOL_LIFETIME), "HELP")
+        ("MACHINE_FACTOR", po::value<double>(&glob.MACHINE_FACTOR), "HELP")
+        ("MACHINE_LIFETIME", po::value<double>(&glob.MACHINE_LIFETIME), "HELP")
+        ("FACTORY_FACTOR", po::value<double>(&glob.FACTORY_FACTOR), "HELP")
+        ("FACTORY_LIFETIME", po::value<double>(&glob.FACTORY_LIFETIME), "HELP")
+        ("INDUSTRY_FACTOR", po::value<double>(&glob.INDUSTRY_FACTOR), "HELP")
+        ("INDUSTRY_LIFETIME", po::value<double>(&glob.INDUSTRY_LIFETIME), "HELP")
+        ("DEV_MACHINE_FACTOR", po::value<double>(&glob.DEV_MACHINE_FACTOR), "HELP")
+        ("DEV_MACHINE_LIFETIME", po::value<double>(&glob.DEV_MACHINE_LIFETIME), "HELP")
+        ("DEV_FACTORY_FACTOR", po::value<double>(&glob.DEV_FACTORY_FACTOR), "HELP")
+        ("DEV_FACTORY_LIFETIME", po::value<double>(&glob.DEV_FACTORY_LIFETIME), "HELP")
+        ("DAYS_OF_DEVICE_TO_HOLD", po::value<double>(&glob.DAYS_OF_DEVICE_TO_HOLD), "HELP")
+        ("TRADE_EXISTS", po::value<bool>(&glob.TRADE_EXISTS), "HELP")
+        ("DEVICES_EXIST", po::value<bool>(&glob.DEVICES_EXIST), "HELP")
+        ("TOOLS_ONLY", po::value<bool>(&glob.TOOLS_ONLY), "HELP")
+        ;
+    return cfgFileOpts;
+}
+
+/**
+ * \param name the name of an option, e.g. MENU_SIZE
+ * \return whether name is an option of the config file.
+ */
+bool isConfigFileOption(string name)
+{
+    return configFileOptions().find_nothrow(name, false) != NULL;
+}
+
 /**
  * Evaluate the given arguments.
  * Throw an exception and stop when entering an arg of wrong type or wrong number of args.
@@ -34,6 +103,8 @@ int parse_args(int argc, char **argv)
     vector<int> remAgentArg;
     vector<int> remResArg;
     vector<string> saveInMiddleArg;
+    vector<int> branchResArg;
+    vector<int> branchAgentArg;
     try {
         /* parse the command line args */
         po::options_description cmdLineOpts("Allowed options");
@@ -50,63 +121,26 @@ int parse_args(int argc, char **argv)
             ("resource,r", po::value< vector<int> >(&remResArg)->multitoken(), "remove a resource mid-run (first arg: which resource to remove, second arg: which day to remove the resource, third arg: 1 for removing the holdings of that resource on the given day, 0 for not)")
             ("middle,m", po::value< vector<string> >(&saveInMiddleArg)->multitoken(), "save the simulation mid-run (first arg: destination folder, second arg: day on which to save)")
             ("verbose,v", po::value<int>(), "set level of debugging output from 0 to 3.  0 = nothing; 3 = everything")
+            ("log-file", po::value<string>(), "write the debugging output to the given file, buffered, instead of the screen")
             ("exchange,e", "store exchange rate data from all trades")
+            ("threads,j", po::value<int>(), "number of threads used to run the agents' work phase; results do not depend on it")
+            ("parallel-trades", "run the resource trading pairs of a round concurrently on the --threads threads")
+            ("legacy-pairing", "draw the resource trading pairs the way older versions did, to reproduce runs made with them")
+            ("branch-res", po::value< vector<int> >(&branchResArg)->multitoken()->composing(), "add a branch of the run that removes a resource (same args as -r); may be repeated. The days before the first removal are run once and shared by the run and its branches")
+            ("branch-agent", po::value< vector<int> >(&branchAgentArg)->multitoken()->composing(), "add a branch of the run that removes an agent (same args as -a); may be repeated")
+            ("branch-fork", "run the branches in forked processes, concurrently with the run, instead of one after the other once the run ends")
+            ("runs", po::value<int>(), "make this many runs of the config in one process, numbered from the -t run number (001 if not set); with -S, each run uses the next seed")
+            ("run-jobs", po::value<int>(), "with --runs or --sweep, the number of runs made at the same time, each in a forked process")
+            ("binary-output", "write long_output as a columnar binary file, long_output.socb, instead of CSV; socb2csv turns it back into the CSV file")
+            ("stats-profile", po::value<string>()->default_value("standard"), "the daily statistics to record: minimal (only long_output is saved), standard (long_output and the other files saved at the end of a run) or full (also by agent and by group, as the files no longer saved need). Below full, only the last days of the stats that are still to be written are kept, not the whole run")
+            ("profile", "time each phase of each day and count the calls of the hot functions and the allocations, in profile_<run number>.csv of the sim folder")
+            ("sweep", po::value<string>(), "make --runs runs at each point of the parameter sweep in the given spec file (see sweep.h); needs -s")
 			 // BRH 3.17.2017: added unique database identifier;
 			("database,d", po::value<string>()->default_value("none"), "unique identifier to join output file measures to config file dimensions")
             ;
 
         /* parse the config file values */
-        po::options_description cfgFileOpts("Config file options");
-        cfgFileOpts.add_options()
-            ("NUM_AGENTS",      po::value<int>(&glob.NUM_AGENTS), "number of agents in this simulation")
-            ("START_DAY",       po::value<int>(&glob.START_DAY),  "the day to start on when restarting a simulation")
-            ("DAY_LENGTH",      po::value<int>(&glob.DAY_LENGTH), "the length of a day")
-            ("NUM_DAYS",        po::value<int>(&glob.NUM_DAYS), "number of days in the simulation")
-            ("NUM_RESOURCES",   po::value<int>(&glob.NUM_RESOURCES), "number of resources in the simulation")
-            ("NUM_AGENT_GROUPS",       po::value<int>(&glob.NUM_AGENT_GROUPS), "number of types of agents in the simulation")
-            ("RES_TRADE_ROUNDS", po::value<int>(&glob.RES_TRADE_ROUNDS), "number of resource trading rounds")
-            ("RES_TRADE_ATTEMPTS", po::value<int>(&glob.RES_TRADE_ATTEMPTS), "number of resource trading attempts")
-            ("DEVICE_TRADE_ROUNDS", po::value<int>(&glob.DEVICE_TRADE_ROUNDS), "number of device trading rounds")
-            ("DEVICE_TRADE_ATTEMPTS", po::value<int>(&glob.DEVICE_TRADE_ATTEMPTS), "number of device trading attempts")
-            ("MENU_SIZE",       po::value<int>(&glob.MENU_SIZE), "Menu size: fix this!")
-            ("DEVICE_TRADE_MEMORY_LENGTH", po::value<int>(&glob.DEVICE_TRADE_MEMORY_LENGTH), "HELP")
-            ("DEVICE_PRODUCTION_MEMORY_LENGTH", po::value<int>(&glob.DEVICE_PRODUCTION_MEMORY_LENGTH), "HELP")
-	    ("MIN_DEVICE_FOR_DEV_DEVICE_CONSIDERATION", po::value<int>(&glob.MIN_DEVICE_FOR_DEV_DEVICE_CONSIDERATION), "HELP")
-	    ("MIN_RES_HELD_FOR_DEVICE_CONSIDERATION", po::value<int>(&glob.MIN_RES_HELD_FOR_DEVICE_CONSIDERATION), "HELP")
-            ("DAILY_EXP_PENALTY", po::value<double>(&glob.DAILY_EXP_PENALTY), "HELP")
-            ("PRODUCTION_EPSILON", po::value<double>(&glob.PRODUCTION_EPSILON), "HELP")
-            ("RESOURCES_IN_TOOL",  po::value<int>(&glob.RESOURCES_IN_TOOL), "number of resources needed to make a tool (?)")
-            ("MAX_RES_EXPERIENCE",  po::value<double>(&glob.MAX_RES_EXPERIENCE), "HELP")
-            ("INVENTOR_DEVICE_EXPERIENCE",  po::value<double>(&glob.INVENTOR_DEVICE_EXPERIENCE), "HELP")
-            ("NUM_DEVICE_COMPONENTS",  po::value<int>(&glob.NUM_DEVICE_COMPONENTS), "HELP")
-            ("MAX_DEVICE_EXPERIENCE",  po::value<double>(&glob.MAX_DEVICE_EXPERIENCE), "HELP")
-            ("DAILY_DEVICE_DECAY",  po::value<double>(&glob.DAILY_DEVICE_DECAY), "HELP")
-            ("MIN_HELD_DEVICE_EXPERIENCE", po::value<double>(&glob.MIN_HELD_DEVICE_EXPERIENCE), "HELP")
-            ("MAX_RES_EFFORT", po::value<double>(&glob.MAX_RES_EFFORT), "HELP")
-            ("MIN_RES_EFFORT", po::value<double>(&glob.MIN_RES_EFFORT), "HELP")
-            ("MAX_DEVICE_EFFORT", po::value<double>(&glob.MAX_DEVICE_EFFORT), "HELP")
-            ("MIN_DEVICE_EFFORT", po::value<double>(&glob.MIN_DEVICE_EFFORT), "HELP")
-            ("MIN_RES_UTIL", po::value<double>(&glob.MIN_RES_UTIL), "HELP")
-            ("TRADE_EPSILON", po::value<double>(&glob.TRADE_EPSILON), "HELP")
-            ("TOOL_PROBABILITY_FACTOR", po::value<double>(&glob.TOOL_PROBABILITY_FACTOR), "HELP")
-            ("DEVICE_PROBABILITY_FACTOR", po::value<double>(&glob.DEVICE_PROBABILITY_FACTOR), "HELP")
-            ("TOOL_FACTOR", po::value<double>(&glob.TOOL_FACTOR), "HELP")
-            ("TOOL_LIFETIME", po::value<double>(&glob.TOOL_LIFETIME), "HELP")
-            ("MACHINE_FACTOR", po::value<double>(&glob.MACHINE_FACTOR), "HELP")
-            ("MACHINE_LIFETIME", po::value<double>(&glob.MACHINE_LIFETIME), "HELP")
-            ("FACTORY_FACTOR", po::value<double>(&glob.FACTORY_FACTOR), "HELP")
-            ("FACTORY_LIFETIME", po::value<double>(&glob.FACTORY_LIFETIME), "HELP")
-            ("INDUSTRY_FACTOR", po::value<double>(&glob.INDUSTRY_FACTOR), "HELP")
-            ("INDUSTRY_LIFETIME", po::value<double>(&glob.INDUSTRY_LIFETIME), "HELP")
-            ("DEV_MACHINE_FACTOR", po::value<double>(&glob.DEV_MACHINE_FACTOR), "HELP")
-            ("DEV_MACHINE_LIFETIME", po::value<double>(&glob.DEV_MACHINE_LIFETIME), "HELP")
-            ("DEV_FACTORY_FACTOR", po::value<double>(&glob.DEV_FACTORY_FACTOR), "HELP")
-            ("DEV_FACTORY_LIFETIME", po::value<double>(&glob.DEV_FACTORY_LIFETIME), "HELP")
-            ("DAYS_OF_DEVICE_TO_HOLD", po::value<double>(&glob.DAYS_OF_DEVICE_TO_HOLD), "HELP")
-            ("TRADE_EXISTS", po::value<bool>(&glob.TRADE_EXISTS), "HELP")
-            ("DEVICES_EXIST", po::value<bool>(&glob.DEVICES_EXIST), "HELP")
-            ("TOOLS_ONLY", po::value<bool>(&glob.TOOLS_ONLY), "HELP")
-            ;
+        po::options_description cfgFileOpts = configFileOptions();
 
         cmdLineOpts.add(cfgFileOpts);
 
@@ -129,6 +163,10 @@ int parse_args(int argc, char **argv)
         if (! foundParamFile) {
               glob.configFilename = "Configs/default.conf"; 
         }
+        if (glob.pointConfigFilename != "") {
+            // a point of a sweep: its config file is the -p one with the swept options changed
+            glob.configFilename = glob.pointConfigFilename;
+        }
 
         po::variables_map vm;
         po::store(po::parse_command_line(argc, argv, cmdLineOpts), vm);
@@ -264,9 +302,29 @@ int parse_args(int argc, char **argv)
         } else {
             glob.saveInMiddle = false;
         }
+        if (branchResArg.size() % 3 != 0) {
+            cerr << "Wrong number of arguments for --branch-res. Should be three per branch." << endl;
+            return -1;
+        }
+        glob.branchResArgs = branchResArg;
+        if (branchAgentArg.size() % 2 != 0) {
+            cerr << "Wrong number of arguments for --branch-agent. Should be two per branch." << endl;
+            return -1;
+        }
+        glob.branchAgentArgs = branchAgentArg;
+        if (vm.count("branch-fork")) {
+            glob.branchForkSet = true;
+        } else {
+            glob.branchForkSet = false;
+        }
         /*
          * For logging level. Print everything whose logging level is <= the number set.
          */
+        if (vm.count("log-file")) {
+            glob.logFileName = vm["log-file"].as<string>();
+        } else {
+            glob.logFileName = "";
+        }
         if (vm.count("verbose")) {
             glob.verboseLevel = vm["verbose"].as<int>();
         } else {
@@ -277,6 +335,74 @@ int parse_args(int argc, char **argv)
         } else {
             glob.saveExchangeRateData = false;
         }
+        if (vm.count("threads")) {
+            glob.NUM_THREADS = vm["threads"].as<int>();
+            if (glob.NUM_THREADS < 1) {
+                cerr << "Number of threads must be at least 1" << endl;
+                return -1;
+            }
+        } else {
+            glob.NUM_THREADS = 1;
+        }
+        if (vm.count("parallel-trades")) {
+            glob.parallelTradesSet = true;
+        } else {
+            glob.parallelTradesSet = false;
+        }
+        if (vm.count("runs")) {
+            glob.numRuns = vm["runs"].as<int>();
+            if (glob.numRuns < 1) {
+                cerr << "Number of runs must be at least 1" << endl;
+                return -1;
+            }
+        } else {
+            glob.numRuns = 1;
+        }
+        if (vm.count("run-jobs")) {
+            glob.runJobs = vm["run-jobs"].as<int>();
+            if (glob.runJobs < 1) {
+                cerr << "Number of run jobs must be at least 1" << endl;
+                return -1;
+            }
+        } else {
+            glob.runJobs = 1;
+        }
+        if (vm.count("sweep")) {
+            glob.sweepSet = true;
+            glob.sweepFilename = vm["sweep"].as<string>();
+            if (! vm.count("save")) {
+                cerr << "--sweep needs a save folder (-s) for its results" << endl;
+                return -1;
+            }
+        } else {
+            glob.sweepSet = false;
+        }
+        if (vm.count("binary-output")) {
+            glob.binaryOutputSet = true;
+        } else {
+            glob.binaryOutputSet = false;
+        }
+        string statsProfile = vm["stats-profile"].as<string>();
+        if (statsProfile == "minimal") {
+            glob.statsProfileArg = STATS_MINIMAL;
+        } else if (statsProfile == "standard") {
+            glob.statsProfileArg = STATS_STANDARD;
+        } else if (statsProfile == "full") {
+            glob.statsProfileArg = STATS_FULL;
+        } else {
+            cerr << "--stats-profile must be minimal, standard or full" << endl;
+            return -1;
+        }
+        if (vm.count("profile")) {
+            glob.profileSet = true;
+        } else {
+            glob.profileSet = false;
+        }
+        if (vm.count("legacy-pairing")) {
+            glob.legacyPairingSet = true;
+        } else {
+            glob.legacyPairingSet = false;
+        }
 		
 		if (vm.count("database")) {
             glob.saveInDatabase = true;
@@ -1,3 +1,8 @@
 
+#include <string>
+
+using namespace std;
+
 int parse_args(int argc, char **argv);
 void readConfigFile();
+bool isConfigFileOption(string name);
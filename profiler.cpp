@@ -0,0 +1,227 @@
+/**
+ * Timing of the phases of each day and counts of the hot calls (see
+ * profiler.h for the file written).
+ */
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <new>
+#include <time.h>
+#include "profiler.h"
+
+static const char *PHASE_NAMES[NUM_PHASES] = {
+    "agentsTradeDevices", "agentsProduceDevices", "agentsTrade", "agentsWork",
+    "agentsInvent", "endDay", "dayAnalysis", "endDayDecay"
+};
+
+static const char *COUNTER_NAMES[NUM_COUNTERS] = {
+    "pairTrade", "makeTrade", "deviceMakeTrade", "barterUtility",
+    "worstCaseConstruction", "allocations", "allocatedBytes"
+};
+
+/**
+ * Every allocation goes through here, so that the profiler can count the
+ * allocations of the day.  The array and nothrow forms below come here
+ * too, and the matching deletes hand the memory back to free(), so that
+ * nothing allocated by malloc() is released by another allocator.  (The
+ * over-aligned forms are left to the library, which allocates and frees
+ * them itself.)
+ */
+void *operator new(size_t size)
+{
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    prof.count(ALLOCATION_COUNT);
+    prof.count(ALLOCATED_BYTES_COUNT, size);
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return operator new(size);
+    } catch (const std::bad_alloc &) {
+        return NULL;
+    }
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    free(p);
+}
+
+/**
+ * Constructor.
+ */
+Profiler::Profiler()
+{
+    enabled = false;
+    currentPhase = NO_PHASE;
+    phaseStart = 0.0;
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        counts[c] = 0;
+        totalCounts[c] = 0;
+    }
+    for (int p = 0; p < NUM_PHASES; p++) {
+        dayTimes[p] = 0.0;
+        totalTimes[p] = 0.0;
+    }
+}
+
+/**
+ * \return the seconds since some fixed time, to the nanosecond.
+ */
+double Profiler::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Start profiling a run: clear the totals and start the file of its rows.
+ * \param filePath the file to write
+ */
+void Profiler::startRun(string filePath)
+{
+    if (file.is_open()) {
+        file.close();
+    }
+    file.clear();
+    file.open(filePath.c_str());
+    if (! file) {
+        cerr << "Could not open the profile file " << filePath << endl;
+        enabled = false;
+        return;
+    }
+    file << "TimeStep";
+    for (int p = 0; p < NUM_PHASES; p++) {
+        file << "," << PHASE_NAMES[p];
+    }
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        file << "," << COUNTER_NAMES[c];
+    }
+    file << "\n";
+    file << fixed << setprecision(9);
+
+    currentPhase = NO_PHASE;
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        counts[c] = 0;
+        totalCounts[c] = 0;
+    }
+    for (int p = 0; p < NUM_PHASES; p++) {
+        dayTimes[p] = 0.0;
+        totalTimes[p] = 0.0;
+    }
+    enabled = true;
+}
+
+/**
+ * End the current phase (if any) and start timing the given one.
+ * \param next the phase to start, or NO_PHASE to just end the current one
+ */
+void Profiler::switchPhase(profile_phase_t next)
+{
+    double t = now();
+    if (currentPhase != NO_PHASE) {
+        dayTimes[currentPhase] += t - phaseStart;
+    }
+    currentPhase = next;
+    phaseStart = t;
+}
+
+/**
+ * End the current phase and write the row of the day.
+ * \param day the day that is over, counted from 0
+ */
+void Profiler::endDay(int day)
+{
+    if (! enabled) {
+        return;
+    }
+    switchPhase(NO_PHASE);
+    int64_t dayCounts[NUM_COUNTERS];
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        dayCounts[c] = __sync_fetch_and_and(&counts[c], 0);
+        totalCounts[c] += dayCounts[c];
+    }
+    for (int p = 0; p < NUM_PHASES; p++) {
+        totalTimes[p] += dayTimes[p];
+    }
+    ostringstream dayName;
+    dayName << day + 1;     // numbered from 1, as TimeStep is in long_output
+    writeRow(dayName.str(), dayTimes, dayCounts);
+    file.flush();   // so that the rows of a run that is killed are kept
+    for (int p = 0; p < NUM_PHASES; p++) {
+        dayTimes[p] = 0.0;
+    }
+}
+
+/**
+ * Write the total row of the run and stop profiling.
+ */
+void Profiler::endRun()
+{
+    if (! enabled) {
+        return;
+    }
+    enabled = false;
+    writeRow("total", totalTimes, totalCounts);
+    file.close();
+}
+
+/**
+ * Write a row of the profile file.
+ * \param day the first field of the row
+ * \param times the seconds of each phase
+ * \param dayCounts the count of each counter
+ */
+void Profiler::writeRow(const string &day, const double *times, const int64_t *dayCounts)
+{
+    file << day;
+    for (int p = 0; p < NUM_PHASES; p++) {
+        file << "," << times[p];
+    }
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        file << "," << dayCounts[c];
+    }
+    file << "\n";
+}
@@ -0,0 +1,95 @@
+/**
+ * The profiler module includes the definition of the Profiler class, which
+ * times the phases of each day of a run and counts the calls of the hot
+ * functions and the memory allocations made in them (see --profile).
+ *
+ * The times and counts of each day are appended to
+ * SIM_SAVE_FOLDER/profile_<run number>.csv as the run goes, one row per
+ * day keyed by TimeStep (numbered from 1, as in long_output), followed by
+ * a "total" row at the end of the run.  When profiling
+ * is off, a phase or a count costs a single test of a flag.
+ */
+
+#ifndef _SOC_PROFILER_H_
+#define _SOC_PROFILER_H_
+
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * \enum profile_phase_t
+ * The timed phases of a day, in the order runDays() goes through them.
+ */
+enum profile_phase_t {
+    TRADE_DEVICES_PHASE = 0,
+    PRODUCE_DEVICES_PHASE,  /*!< 1 */
+    TRADE_PHASE,            /*!< 2 (both trading rounds of the day) */
+    WORK_PHASE,             /*!< 3 */
+    INVENT_PHASE,           /*!< 4 */
+    END_DAY_PHASE,          /*!< 5 */
+    DAY_ANALYSIS_PHASE,     /*!< 6 */
+    END_DAY_DECAY_PHASE,    /*!< 7 */
+    NUM_PHASES,
+    NO_PHASE = NUM_PHASES
+};
+
+/**
+ * \enum profile_counter_t
+ * The counted events.
+ */
+enum profile_counter_t {
+    PAIR_TRADE_COUNT = 0,
+    MAKE_TRADE_COUNT,               /*!< 1 (resource trades made) */
+    DEVICE_TRADE_COUNT,             /*!< 2 (device trades made) */
+    BARTER_UTILITY_COUNT,           /*!< 3 */
+    WORST_CASE_CONSTRUCTION_COUNT,  /*!< 4 */
+    ALLOCATION_COUNT,               /*!< 5 */
+    ALLOCATED_BYTES_COUNT,          /*!< 6 */
+    NUM_COUNTERS
+};
+
+class Profiler
+{
+private:
+    volatile bool enabled;
+    volatile int64_t counts[NUM_COUNTERS];     //!< the counts of the current day
+    double dayTimes[NUM_PHASES];                //!< the seconds of each phase of the current day
+    double totalTimes[NUM_PHASES];
+    int64_t totalCounts[NUM_COUNTERS];
+    profile_phase_t currentPhase;
+    double phaseStart;
+    ofstream file;
+
+    static double now();
+    void writeRow(const string &day, const double *times, const int64_t *dayCounts);
+
+public:
+    Profiler();
+    void startRun(string filePath);
+    void endRun();
+
+    /**
+     * End the current phase (if any) and start timing the given one.
+     */
+    void phase(profile_phase_t next) { if (enabled) { switchPhase(next); } }
+    void switchPhase(profile_phase_t next);
+    void endDay(int day);
+
+    /**
+     * Count n events of the given kind; safe to call from any thread.
+     */
+    void count(profile_counter_t counter, int64_t n = 1)
+    {
+        if (enabled) {
+            __sync_fetch_and_add(&counts[counter], n);
+        }
+    }
+};
+
+extern Profiler prof;
+
+
+#endif
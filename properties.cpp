@@ -29,8 +29,29 @@
 
 #include "properties.h"
 #include "globals.h"
+#include "binaryio.h"
 #include <cmath>
 #include <cassert>
+#include <map>
+#include <boost/thread/mutex.hpp>
+
+/*
+ * The utility and effort curves only depend on the parameters they are
+ * computed from, so each one is computed once and shared, read-only, by
+ * all the agents (and runs) with the same parameters; with a single agent
+ * group that is one curve of each kind per resource.  The maps never drop
+ * a curve, so the pointers to them stay valid.
+ */
+struct UtilityCurves
+{
+    vector<double> marginal;
+    vector<double> cumulative;
+};
+static map<vector<double>, UtilityCurves> utilityCurveCache;
+static map<vector<double>, vector<double> > resEffortCache;
+static map<vector<double>, vector<double> > deviceEffortCache;
+static boost::mutex curveCacheMutex;
+static const vector<double> noCurve;    //!< the curves before they are computed
 
 
 /**
@@ -43,20 +64,19 @@ ResProperties::ResProperties()
     endDayUtilities = 0.0;
     steepness = 0.0;
     scaling = 0.0;
-    assert(marginalUtilities.empty());
-    marginalUtilities.clear();
+    marginalUtilities = &noCurve;
+    cumulativeUtilities = &noCurve;
     averageLifetime = 0.0;
 
-    held = 0;
+    held = NULL;         // see bindState()
     idleResource = true;
-    experience = 0.0;
+    experience = NULL;
 
     minResEffort = 0.0;
     maxResEffort = 0.0;
     maxResExperience = 0.0;
 
-    assert(resEfforts.empty());
-    resEfforts.clear();
+    resEfforts = &noCurve;
 
     resSetAside = 0;
     unitsGatheredToday = 0;
@@ -71,14 +91,25 @@ ResProperties::ResProperties()
 }
 
 /**
- * Calculate the efforts needed to gather a resource.
+ * Calculate the efforts needed to gather a resource, or share the ones
+ * already calculated for the same parameters.
  */
 void ResProperties::calcResEfforts()
 {
-    assert(resEfforts.empty());
-    resEfforts.clear();
+    vector<double> key;
+    key.push_back(minResEffort);
+    key.push_back(maxResEffort);
+    key.push_back(maxResExperience);
+    boost::mutex::scoped_lock lock(curveCacheMutex);
+    map<vector<double>, vector<double> >::iterator cached = resEffortCache.find(key);
+    if (cached != resEffortCache.end()) {
+        resEfforts = &cached->second;
+        return;
+    }
+    vector<double> &efforts = resEffortCache[key];
+    resEfforts = &efforts;
     for (int potentialExp = 0; potentialExp < int(maxResExperience); potentialExp++) {
-        resEfforts.push_back(maxResEffort -
+        efforts.push_back(maxResEffort -
                 (maxResEffort - minResEffort)
                 * exp(- sqrt(maxResEffort) * 2
                 * exp(-(maxResEffort - minResEffort)
@@ -89,10 +120,26 @@ void ResProperties::calcResEfforts()
 
 /**
  * Calculate the initial values of marginal utilities based off of
- * the preferences of the agents of the given resource.
+ * the preferences of the agents of the given resource, or share the ones
+ * already calculated for the same preferences.
  */
 void ResProperties::calcMarginalUtilities()
 {
+    vector<double> key;
+    key.push_back(steepness);
+    key.push_back(scaling);
+    key.push_back(glob.MIN_RES_UTIL);
+    boost::mutex::scoped_lock lock(curveCacheMutex);
+    map<vector<double>, UtilityCurves>::iterator cached = utilityCurveCache.find(key);
+    if (cached != utilityCurveCache.end()) {
+        marginalUtilities = &cached->second.marginal;
+        cumulativeUtilities = &cached->second.cumulative;
+        return;
+    }
+    UtilityCurves &curves = utilityCurveCache[key];
+    marginalUtilities = &curves.marginal;
+    cumulativeUtilities = &curves.cumulative;
+
     double potentialHeld = 1.0;
     double util = scaling * pow(potentialHeld, (1.0 / steepness));
     vector<double> utils(1, 0.0);
@@ -105,18 +152,66 @@ void ResProperties::calcMarginalUtilities()
     }
     // The marginal utility, then, is the difference between consecutive
     // values in the utility list.
-    assert(marginalUtilities.empty());
-    marginalUtilities.clear();
     for (int i = 1; i < (int) utils.size(); i++) {
-        marginalUtilities.push_back(utils[i] - utils[i - 1]);
+        curves.marginal.push_back(utils[i] - utils[i - 1]);
     }
+    // Running sums of the marginal utilities, for utilityOfUnits().
+    curves.cumulative.push_back(0.0);
+    for (int i = 0; i < (int) curves.marginal.size(); i++) {
+        curves.cumulative.push_back(curves.cumulative[i] + curves.marginal[i]);
+    }
+}
+
+/**
+ * Point the held units and the experience to their slots in
+ * glob.agentState.
+ */
+void ResProperties::bindState(int *heldSlot, double *experienceSlot)
+{
+    held = heldSlot;
+    experience = experienceSlot;
+}
+
+/**
+ * Write the values that change during a run to a day status file.
+ * The utility and effort curves are not written: they are computed again
+ * from the agent's personalValues.
+ */
+void ResProperties::saveState(ostream &out) const
+{
+    writeBinary(out, endDayUtilities);
+    writeBinary(out, *held);
+    writeBinary(out, idleResource);
+    writeBinary(out, *experience);
+    writeBinary(out, resSetAside);
+    writeBinary(out, unitsGatheredToday);
+    writeBinary(out, beforeWorkMU);
+    writeBinary(out, beforeWorkHeld);
+    writeBinary(out, unitsGatheredEndWork);
+    writeBinary(out, boughtEndWork);
+    writeBinary(out, soldEndWork);
+    writeBinary(out, boughtEndDay);
+    writeBinary(out, soldEndDay);
 }
 
 /**
- * mutator method for held.
+ * Read back the values written by saveState().
  */
-void ResProperties::setHeld(int newHeld) {
-    held = newHeld;
+void ResProperties::loadState(istream &in)
+{
+    readBinary(in, endDayUtilities);
+    readBinary(in, *held);
+    readBinary(in, idleResource);
+    readBinary(in, *experience);
+    readBinary(in, resSetAside);
+    readBinary(in, unitsGatheredToday);
+    readBinary(in, beforeWorkMU);
+    readBinary(in, beforeWorkHeld);
+    readBinary(in, unitsGatheredEndWork);
+    readBinary(in, boughtEndWork);
+    readBinary(in, soldEndWork);
+    readBinary(in, boughtEndDay);
+    readBinary(in, soldEndDay);
 }
 
 /**
@@ -132,10 +227,9 @@ DevProperties::DevProperties()
     maxDeviceEffort = 0.0;
     maxDeviceExperience = 0.0; 
 
-    assert(deviceEfforts.empty());
-    deviceEfforts.clear();
+    deviceEfforts = &noCurve;
 
-    deviceHeld = 0;
+    deviceHeld = NULL;      // see bindState()
     idleDevice = true;
     devicesToMake = 0;
     devicesSetAside = 0;
@@ -145,6 +239,10 @@ DevProperties::DevProperties()
     costOfDeviceMemoryValid = false;
     worstCaseConstructionMemory = make_pair(0.0, vector<int>(glob.NUM_RESOURCES, 0));
     worstCaseConstructionMemoryValid = false;
+    for (int memory = 0; memory < NUM_DEVICE_MEMORIES; memory++) {
+        memoryEpoch[memory] = 0;
+        memoryStale[memory] = false;
+    }
 
     devicesMadeToday = 0;
     devicesMadeTotal = 0;
@@ -154,19 +252,89 @@ DevProperties::DevProperties()
     deviceMinutesUsedTotal = 0;
     deviceMinutesDecayTotal = 0;
 
-    devicePrices = vector<double>(glob.DEVICE_TRADE_MEMORY_LENGTH, 0.0);
-    devicesRecentlyMade = vector<int>(glob.DEVICE_PRODUCTION_MEMORY_LENGTH, 0);
+    devicePrices = RingMemory<double>(glob.DEVICE_TRADE_MEMORY_LENGTH, 0.0);
+    devicesRecentlyMade = RingMemory<int>(glob.DEVICE_PRODUCTION_MEMORY_LENGTH, 0);
 }
 
+/**
+ * Calculate the efforts needed to make a device, or share the ones
+ * already calculated for the same parameters.
+ */
 void DevProperties::calcDeviceEfforts()
 {
-    assert(deviceEfforts.empty());
-    deviceEfforts.clear();
+    vector<double> key;
+    key.push_back(minDeviceEffort);
+    key.push_back(maxDeviceEffort);
+    key.push_back(maxDeviceExperience);
+    boost::mutex::scoped_lock lock(curveCacheMutex);
+    map<vector<double>, vector<double> >::iterator cached = deviceEffortCache.find(key);
+    if (cached != deviceEffortCache.end()) {
+        deviceEfforts = &cached->second;
+        return;
+    }
+    vector<double> &efforts = deviceEffortCache[key];
+    deviceEfforts = &efforts;
     for (int potentialExp = 0; potentialExp < int(maxDeviceExperience); potentialExp++) {
-        deviceEfforts.push_back( maxDeviceEffort -
+        efforts.push_back( maxDeviceEffort -
                 (maxDeviceEffort - minDeviceEffort)
                 * exp(-maxDeviceEffort * 2
                 * exp(-(maxDeviceEffort - minDeviceEffort) / 2
                 * potentialExp / maxDeviceExperience)));
     }
 }
+
+/**
+ * Write the values that change during a run to a day status file.
+ */
+void DevProperties::saveState(ostream &out) const
+{
+    writeBinary(out, deviceExperience);
+    writeBinary(out, *deviceHeld);
+    writeBinary(out, idleDevice);
+    writeBinary(out, devicesToMake);
+    writeBinary(out, devicesSetAside);
+    writeBinary(out, gainOverDeviceLifeMemory);
+    writeBinary(out, gainOverDeviceLifeMemoryValid);
+    writeBinary(out, costOfDeviceMemory);
+    writeBinary(out, costOfDeviceMemoryValid);
+    writeBinary(out, worstCaseConstructionMemory);
+    writeBinary(out, worstCaseConstructionMemoryValid);
+    writeBinary(out, devicesMadeToday);
+    writeBinary(out, devicesMadeTotal);
+    writeBinary(out, devicesSoldTotal);
+    writeBinary(out, devicesBoughtTotal);
+    writeBinary(out, deviceMinutesUsedTotal);
+    writeBinary(out, deviceMinutesDecayTotal);
+    writeBinary(out, devicePrices.toVector());
+    writeBinary(out, devicesRecentlyMade.toVector());
+}
+
+/**
+ * Read back the values written by saveState().
+ */
+void DevProperties::loadState(istream &in)
+{
+    readBinary(in, deviceExperience);
+    readBinary(in, *deviceHeld);
+    readBinary(in, idleDevice);
+    readBinary(in, devicesToMake);
+    readBinary(in, devicesSetAside);
+    readBinary(in, gainOverDeviceLifeMemory);
+    readBinary(in, gainOverDeviceLifeMemoryValid);
+    readBinary(in, costOfDeviceMemory);
+    readBinary(in, costOfDeviceMemoryValid);
+    readBinary(in, worstCaseConstructionMemory);
+    readBinary(in, worstCaseConstructionMemoryValid);
+    readBinary(in, devicesMadeToday);
+    readBinary(in, devicesMadeTotal);
+    readBinary(in, devicesSoldTotal);
+    readBinary(in, devicesBoughtTotal);
+    readBinary(in, deviceMinutesUsedTotal);
+    readBinary(in, deviceMinutesDecayTotal);
+    vector<double> prices;
+    vector<int> recentlyMade;
+    readBinary(in, prices);
+    readBinary(in, recentlyMade);
+    devicePrices.assign(prices);
+    devicesRecentlyMade.assign(recentlyMade);
+}
@@ -2,6 +2,8 @@
 #define _SOC_PROPERTIES_H_
 
 #include <vector>
+#include <iostream>
+#include "ringmemory.h"
 using namespace std;
 
 struct ResProperties
@@ -12,29 +14,43 @@ struct ResProperties
      */
     double endDayUtilities;
 
+private:
     /**
      * The marginal utility of the associated resource at the amount
-     * held of that resource.
+     * held of that resource.  The curves are read-only and shared by all
+     * the agents with the same parameters (see calcMarginalUtilities()).
      */
-    vector<double> marginalUtilities;
-private:
+    const vector<double> *marginalUtilities;
     /**
-     * Keeps track of the number of units of all resources this agent is
-     * holding.
+     * cumulativeUtilities[i] is the sum of the first i marginalUtilities,
+     * so the utility of any range of units is a difference of two entries.
+     * Filled in with marginalUtilities by calcMarginalUtilities().
      */
-    int held;
-public:
+    const vector<double> *cumulativeUtilities;
     /**
-     * False if the agent worked on the resource during the day,
-     * and True if the agent did not.
+     * The effort function of the agent (maps experience to
+     * number of minutes required to extract a resource.)  Shared like
+     * marginalUtilities.
      */
-    int idleResource;
+    const vector<double> *resEfforts;
+    /**
+     * Keeps track of the number of units of all resources this agent is
+     * holding (its slot in glob.agentState).
+     */
+    int *held;
     /**
      * the amount of experience the agent has producing the
      * corresponding resource (note that this experience can be reduced by
      * a penalty if the agent doesn't work on a resource during a day).
+     * Its slot in glob.agentState.
+     */
+    double *experience;
+public:
+    /**
+     * False if the agent worked on the resource during the day,
+     * and True if the agent did not.
      */
-    double experience;
+    int idleResource;
     /**
      * When trading devices, agents have to set aside resources
      * so that they will have enough to make the devices that they agree to
@@ -58,17 +74,37 @@ public:
     double minResEffort;
     double maxResEffort;
     double maxResExperience;
-    /**
-     * The effort function of the agent (maps experience to
-     * number of minutes required to extract a resource.)
-     */
-    vector<double> resEfforts;
 
     ResProperties();
     void calcResEfforts();
     void calcMarginalUtilities();
-    void setHeld(int newHeld);
-    int getHeld() const { return held; }
+    /**
+     * \return the sum of marginalUtilities[from] to marginalUtilities[to - 1],
+     * where 0 <= from <= to <= marginalUtilities.size().
+     */
+    double utilityOfUnits(int from, int to) const
+        { return (*cumulativeUtilities)[to] - (*cumulativeUtilities)[from]; }
+    const vector<double> &getMarginalUtilities() const { return *marginalUtilities; }
+    const vector<double> &getResEfforts() const { return *resEfforts; }
+    void saveState(ostream &out) const;
+    void loadState(istream &in);
+    void bindState(int *heldSlot, double *experienceSlot);
+    void setHeld(int newHeld) { *held = newHeld; }
+    int getHeld() const { return *held; }
+    double getExperience() const { return *experience; }
+    void setExperience(double newExperience) { *experience = newExperience; }
+};
+
+
+/**
+ * \enum device_memory_t
+ * The values that agents memorize for each device (see DevProperties).
+ */
+enum device_memory_t {
+    GAIN_MEMORY,
+    COST_MEMORY,
+    WORST_CASE_MEMORY,
+    NUM_DEVICE_MEMORIES
 };
 
 
@@ -76,14 +112,13 @@ struct DevProperties
 {
 private:
     double deviceExperience;    //!< The amount of experience that the agent has in the device.
+    const vector<double> *deviceEfforts;    //!< shared by the agents with the same parameters (see calcDeviceEfforts())
+    double *deviceHeld;         //!< Number of minutes of the device currently held by the agent (its slot in glob.agentState)
 public:
     double minDeviceEffort;
     double maxDeviceEffort;
     double maxDeviceExperience;
 
-    vector<double> deviceEfforts;   //!< initialized to be an empty list in py
-
-    double deviceHeld;		//!< Number of minutes of the device currently held by the agent
     bool idleDevice;		//!< Indicates whether or not the agent has built or used this device
     int devicesToMake;		//!< Keeps track of the devices that the agent has agreed to make during device trading.
     /**
@@ -98,6 +133,14 @@ public:
     bool costOfDeviceMemoryValid;
     pair < double, vector<int> > worstCaseConstructionMemory;	//!< Memorizes worstCaseConstruction
     bool worstCaseConstructionMemoryValid;
+    /**
+     * For each of the memories above (indexed by device_memory_t), the
+     * agent's device memory epoch when it was last computed or used, and
+     * whether something it was computed from has changed since then
+     * (see Agent::refreshDeviceGainAndCostMemory()).
+     */
+    int memoryEpoch[NUM_DEVICE_MEMORIES];
+    bool memoryStale[NUM_DEVICE_MEMORIES];
     /**
      * This is to keep track of devices made on the current day.
      *  Primarily for statistical purposes
@@ -128,20 +171,44 @@ public:
     /**
      * Each element in these lists is a list of the five most recent
      * prices (in terms of utility given up) of the device of the
-     * corresponding resource.
+     * corresponding resource (DEVICE_TRADE_MEMORY_LENGTH of them, the
+     * most recent first).
      */
-    vector<double> devicePrices;
+    RingMemory<double> devicePrices;
     /**
      * This list keeps track of devices that have been made
-     * within the set memory length.
+     * within the set memory length (DEVICE_PRODUCTION_MEMORY_LENGTH days,
+     * today first).
      */
-    vector<int> devicesRecentlyMade;
+    RingMemory<int> devicesRecentlyMade;
 
     DevProperties();
     void calcDeviceEfforts();
+    const vector<double> &getDeviceEfforts() const { return *deviceEfforts; }
     double getDeviceExperience() { return deviceExperience; };
     void setDeviceExperience(double newDE) { deviceExperience = newDE; };
+    void bindState(double *deviceHeldSlot) { deviceHeld = deviceHeldSlot; }
+    double getDeviceHeld() const { return *deviceHeld; }
+    void setDeviceHeld(double newDeviceHeld) { *deviceHeld = newDeviceHeld; }
+    bool &memoryValid(device_memory_t memory);
+    void saveState(ostream &out) const;
+    void loadState(istream &in);
 };
 
+/**
+ * \return the valid flag of the given memory.
+ */
+inline bool &DevProperties::memoryValid(device_memory_t memory)
+{
+    switch (memory) {
+    case GAIN_MEMORY:
+        return gainOverDeviceLifeMemoryValid;
+    case COST_MEMORY:
+        return costOfDeviceMemoryValid;
+    default:
+        return worstCaseConstructionMemoryValid;
+    }
+}
+
 #endif
 
@@ -34,7 +34,7 @@ typedef boost::mt19937 base_generator_type;
 //typedef boost::lagged_fibonacci607 base_generator_type;
 
 #ifdef unix
-uint64_t GetSeed()
+inline uint64_t GetSeed()
 {
         uint64_t seed;
         std::ifstream urandom;
@@ -45,7 +45,7 @@ uint64_t GetSeed()
 }
 #else
 // TODO: Implement a proper GetSeed() on other platforms
-uint64_t GetSeed()
+inline uint64_t GetSeed()
 {
 	return time(NULL);
 }
@@ -61,6 +61,9 @@ public:
         Ran01(void) : generator((uint64_t)GetSeed()), gen(generator) { }
 
         realtype operator () (void) { return gen(); } ///< Generate a random number
+
+        void save(std::ostream &os) const { os << gen; }    ///< Write the generator state as text
+        void load(std::istream &is) { is >> gen; }          ///< Read a state written by save()
 };
 
 /// Binomial distribution random numbers, with given n and p.
@@ -79,6 +82,9 @@ public:
             gen(generator, my_binomial);
         return gen();
     }
+
+    void save(std::ostream &os) const { os << generator; }  ///< Write the generator state as text
+    void load(std::istream &is) { is >> generator; }        ///< Read a state written by save()
 };
 
 
@@ -0,0 +1,103 @@
+/**
+ * Per-agent random number streams.
+ * The generator is splitmix64: the state is a counter started from a
+ * hash of (glob.streamSeed, phase, day, agent id), and each value is the
+ * mixed counter.  Creating a stream is as cheap as a few multiplications,
+ * so the streams are made on the spot instead of being kept in the agents.
+ */
+#include <boost/random/binomial_distribution.hpp>
+#include "randomstream.h"
+#include "globals.h"
+
+/**
+ * The splitmix64 finalizer; a bijection on 64 bit values that spreads
+ * every input bit over the whole output.
+ */
+uint64_t RandomStream::mix(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Constructor.
+ * \param agentId the name of the agent drawing from this stream
+ * \param day the current day
+ * \param phase the phase of the day
+ */
+RandomStream::RandomStream(int agentId, int day, stream_phase_t phase)
+{
+    state = mix(glob.streamSeed ^ (uint64_t) phase);
+    state = mix(state ^ (uint64_t) day);
+    state = mix(state ^ (uint64_t) agentId);
+}
+
+/**
+ * \return the next 64 random bits of the stream.
+ */
+RandomStream::result_type RandomStream::operator()()
+{
+    state += 0x9e3779b97f4a7c15ULL;
+    return mix(state);
+}
+
+/**
+ * Skip the next n draws of the stream, in constant time.
+ */
+void RandomStream::discard(uint64_t n)
+{
+    state += n * 0x9e3779b97f4a7c15ULL;
+}
+
+/**
+ * \return a random double in range [lower, upper).
+ */
+double RandomStream::random_range(double lower, double upper)
+{
+    return (random_01() * (upper - lower)) + lower;
+}
+
+/**
+ * \return a random double in range [0.0, 1.0), using the top 53 bits.
+ */
+double RandomStream::random_01()
+{
+    return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * \return an random integer value in range [lower, upper).
+ */
+int RandomStream::random_int(int lower, int upper)
+{
+    return ((int) random_range(lower, upper));
+}
+
+/**
+ * \returns an random integer value in range [lower, upper].
+ */
+int RandomStream::random_int_inclusive(int lower, int upper)
+{
+    return random_int(lower, upper + 1);
+}
+
+/**
+ * \param vec a vector of integers
+ * \return an int randomly chosen from the vector.
+ */
+int RandomStream::random_choice(vector<int> &vec)
+{
+    return vec[random_int(0, vec.size())];
+}
+
+/**
+ * \param n the number of independent experiements.
+ * \param p the probability of success
+ * \return an int randomly from a binomial distribution.
+ */
+int RandomStream::random_binomial(int n, double p)
+{
+    boost::random::binomial_distribution<int> binomial(n, p);
+    return binomial(*this);
+}
@@ -0,0 +1,51 @@
+/**
+ * The randomstream module includes the definition of the RandomStream
+ * class, a counter-based random number generator keyed by the run seed,
+ * an agent, a day and a phase of the day.  Every agent draws from its own
+ * stream in each phase, so the values it gets do not depend on the order
+ * in which the agents are handled (or on how many threads handle them).
+ */
+
+#ifndef _SOC_RANDOMSTREAM_H_
+#define _SOC_RANDOMSTREAM_H_
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * \enum stream_phase_t
+ * The phases of a day that draw from per-agent streams.
+ */
+enum stream_phase_t {
+    WORK_STREAM = 0,
+    INVENT_STREAM,  /*!< 1 */
+    DECAY_STREAM    /*!< 2 */
+};
+
+class RandomStream
+{
+private:
+    uint64_t state;
+    static uint64_t mix(uint64_t x);
+
+public:
+    /* Makes RandomStream usable as an engine for boost distributions. */
+    typedef uint64_t result_type;
+    static result_type min() { return 0; }
+    static result_type max() { return ~((result_type) 0); }
+    result_type operator()();
+    void discard(uint64_t n);
+
+    RandomStream(int agentId, int day, stream_phase_t phase);
+    double random_range(double lower, double upper);
+    double random_01();
+    int random_int(int lower, int upper);
+    int random_int_inclusive(int lower, int upper);
+    int random_choice(vector<int> &vec);
+    int random_binomial(int n, double p);
+};
+
+
+#endif
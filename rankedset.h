@@ -0,0 +1,76 @@
+/**
+ * The rankedset module includes the definition of the RankedSet class, a
+ * set of the indexes 0 to n-1 that starts full and from which indexes are
+ * removed.  It answers whether an index is still in the set and which
+ * index is the k-th smallest left (what the k-th element of a sorted
+ * vector would be after erasing the removed ones from it) in O(log n),
+ * with a Fenwick tree of the number of indexes left.
+ */
+
+#ifndef _SOC_RANKEDSET_H_
+#define _SOC_RANKEDSET_H_
+
+#include <vector>
+
+using namespace std;
+
+class RankedSet
+{
+private:
+    int slots;                  //!< n, the number of indexes the set started with
+    int members;                //!< the number of indexes left
+    int topStep;                //!< the highest power of 2 not above slots
+    vector<int> tree;           //!< tree[i] counts the indexes left in (i - (i & -i), i], 1-based
+    vector<bool> member;
+
+public:
+    /**
+     * Constructor.
+     * \param n the set starts with the indexes 0 to n-1
+     */
+    RankedSet(int n = 0) : slots(n), members(n), tree(n + 1), member(n, true)
+    {
+        for (int i = 1; i <= slots; i++) {
+            tree[i] = i & -i;
+        }
+        topStep = 1;
+        while (topStep * 2 <= slots) {
+            topStep *= 2;
+        }
+    }
+
+    int size() const { return members; }
+    bool contains(int index) const { return member[index]; }
+
+    /**
+     * \return the index that has rank smaller indexes left before it
+     * (0 <= rank < size()).
+     */
+    int select(int rank) const
+    {
+        int pos = 0;
+        int remaining = rank + 1;
+        for (int step = topStep; step > 0; step /= 2) {
+            if (pos + step <= slots && tree[pos + step] < remaining) {
+                pos += step;
+                remaining -= tree[pos];
+            }
+        }
+        return pos;         // the 1-based position pos + 1 is index pos
+    }
+
+    /**
+     * Remove an index that is in the set.
+     */
+    void erase(int index)
+    {
+        member[index] = false;
+        members--;
+        for (int i = index + 1; i <= slots; i += i & -i) {
+            tree[i]--;
+        }
+    }
+};
+
+
+#endif
@@ -14,12 +14,21 @@
 #ifndef _SOC_RESOURCE_H_
 #define _SOC_RESOURCE_H_
 
+#include <vector>
+
+class Device;
+
 class Resource
 {
 public:
 
     bool inSimulation;
     int ID;
+    /**
+     * The discovered tools that this resource is a component of (kept up
+     * to date by the constructor and the destructor of Device).
+     */
+    std::vector<Device *> usedIn;
 
     Resource(int id);
     /**
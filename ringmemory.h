@@ -0,0 +1,117 @@
+/**
+ * The ringmemory module includes the definition of the RingMemory class
+ * template, the fixed-length memory of the most recent values of
+ * something (the prices paid for a device, the devices made each day).
+ * Remembering a new value forgets the oldest one in constant time, and
+ * the sums that the agents ask for are kept up to date as the memory
+ * changes instead of being computed again on every question.
+ */
+
+#ifndef _SOC_RINGMEMORY_H_
+#define _SOC_RINGMEMORY_H_
+
+#include <vector>
+
+using namespace std;
+
+template <class T>
+class RingMemory
+{
+private:
+    vector<T> values;
+    int newest;             //!< the index in values of the most recent value
+    T sum;                  //!< the sum of all the values
+    int positives;          //!< the number of values above 0
+    T positiveSum;          //!< the sum of the values above 0
+
+    /*
+     * Sum the values from the most recent to the oldest, the order in
+     * which they used to be summed, so the sums come out to the same bits.
+     * Only called when a value changes, and the memories are short.
+     */
+    void recount()
+    {
+        sum = T();
+        positives = 0;
+        positiveSum = T();
+        for (int age = 0; age < (int) values.size(); age++) {
+            const T &value = (*this)[age];
+            sum += value;
+            if (value > 0) {
+                positives++;
+                positiveSum += value;
+            }
+        }
+    }
+
+public:
+    /**
+     * Constructor.
+     * \param length the number of values remembered
+     * \param initial the value each of them starts with
+     */
+    RingMemory(int length = 0, T initial = T()) :
+        values(length, initial), newest(0)
+    {
+        recount();
+    }
+
+    int size() const { return (int) values.size(); }
+
+    /**
+     * \return the value remembered age values ago (0 is the most recent).
+     */
+    const T &operator[](int age) const { return values[(newest + age) % values.size()]; }
+
+    /**
+     * Remember a new value, forgetting the oldest one.
+     */
+    void remember(T value)
+    {
+        if (values.empty()) {
+            return;
+        }
+        newest = (newest + values.size() - 1) % values.size();
+        values[newest] = value;
+        recount();
+    }
+
+    /**
+     * Add to the most recent value.
+     */
+    void addToNewest(T amount)
+    {
+        values[newest] += amount;
+        recount();
+    }
+
+    T total() const { return sum; }
+    int numPositive() const { return positives; }
+    T positiveTotal() const { return positiveSum; }
+
+    /**
+     * \return the values, from the most recent to the oldest.
+     */
+    vector<T> toVector() const
+    {
+        vector<T> ordered;
+        for (int age = 0; age < size(); age++) {
+            ordered.push_back((*this)[age]);
+        }
+        return ordered;
+    }
+
+    /**
+     * Replace the values with the given ones, from the most recent to the
+     * oldest (see toVector()).
+     */
+    void assign(const vector<T> &ordered)
+    {
+        values = ordered;
+        newest = 0;
+        recount();
+    }
+};
+
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * socb2csv: print a column file written by societies (see --binary-output
+ * and columnfile.h) as CSV, in the same format as the CSV file it replaces.
+ * To run it, type ./socb2csv long_output.socb > long_output.csv
+ * Missing values (NaN) are printed as '.'.
+ */
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include "columnfile.h"
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        cerr << "usage: " << argv[0] << " FILE.socb > FILE.csv" << endl;
+        return 1;
+    }
+    ifstream in(argv[1], ios::binary);
+    if (! in) {
+        cerr << "Could not open " << argv[1] << endl;
+        return 1;
+    }
+    vector<ColumnSpec> specs;
+    if (! ColumnChunk::readHeader(in, specs)) {
+        cerr << argv[1] << ": could not read the header" << endl;
+        return 1;
+    }
+    for (unsigned col = 0; col < specs.size(); col++) {
+        cout << (col == 0 ? "" : ",") << specs[col].name;
+    }
+    cout << "\n";
+
+    ColumnChunk chunk(specs);
+    while (chunk.read(in)) {
+        for (int row = 0; row < chunk.numRows(); row++) {
+            for (unsigned col = 0; col < specs.size(); col++) {
+                if (col > 0) {
+                    cout << ",";
+                }
+                switch (specs[col].type) {
+                case STRING_COLUMN:
+                    cout << chunk.getString(col, row);
+                    break;
+                case INT_COLUMN:
+                    cout << chunk.getInt(col, row);
+                    break;
+                case DOUBLE_COLUMN:
+                    if (std::isnan(chunk.getDouble(col, row))) {
+                        cout << ".";
+                    } else {
+                        cout << chunk.getDouble(col, row);
+                    }
+                    break;
+                }
+            }
+            cout << "\n";
+        }
+    }
+    return 0;
+}
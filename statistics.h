@@ -0,0 +1,92 @@
+/**
+ * The statistics module includes the functions that sum up the values of
+ * a day over the agents (or over the resources) for the result files: the
+ * Gini coefficient, the median and the quartiles.  They take the values
+ * by reference and reorder them, so the caller's vector is reused instead
+ * of copied.  The Gini coefficient takes one sort, O(n log n); the median
+ * and quartiles are found by selection (nth_element), O(n).
+ */
+
+#ifndef _SOC_STATISTICS_H_
+#define _SOC_STATISTICS_H_
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/**
+ * \return the Gini coefficient of values, 1 + 1/n - 2B where B is the sum
+ * of the running totals of the sorted values over n times their total,
+ * or NaN if there are no values.  The values are sorted.
+ */
+inline double gini(vector<double> &values)
+{
+    if (values.empty()) {
+        return NAN;
+    }
+    sort(values.begin(), values.end());
+    /*
+     * Each running total is kept in an int, cut to an int after every
+     * value is added, as the totals were when each was summed on its own
+     * with accumulate(..., 0); the sum of the totals is a double.
+     */
+    int total = 0;
+    double sumOfTotals = 0.0;
+    for (unsigned i = 0; i < values.size(); i++) {
+        total += values[i];
+        sumOfTotals += total;
+    }
+    double B = sumOfTotals / (double(total) * double(values.size()));
+    return 1.0 + (1.0 / double(values.size())) - (2.0 * B);
+}
+
+/**
+ * \return the median of values, the mean of the two middle ones if there
+ * is an even number of them.  values must not be empty; they are
+ * reordered.
+ */
+inline double median(vector<double> &values)
+{
+    unsigned half = values.size() / 2;
+    nth_element(values.begin(), values.begin() + half, values.end());
+    double upper = values[half];
+    if (values.size() % 2 != 0) {
+        return upper;
+    }
+    // the values before half are the smaller half, in no order
+    double lower = *max_element(values.begin(), values.begin() + half);
+    return (lower + upper) / 2.0;
+}
+
+/**
+ * \return the min, first quartile, median, third quartile and max of
+ * values.  The first (third) quartile is the median of the values at or
+ * below (at or above) the median.  values must not be empty; they are
+ * reordered.
+ */
+inline vector<double> quartiles(vector<double> &values)
+{
+    double mid = median(values);
+    vector<double> below;
+    vector<double> above;
+    for (unsigned i = 0; i < values.size(); i++) {
+        if (values[i] >= mid) {
+            above.push_back(values[i]);
+        }
+        if (values[i] <= mid) {
+            below.push_back(values[i]);
+        }
+    }
+    vector<double> result;
+    result.push_back(*min_element(below.begin(), below.end()));
+    result.push_back(median(below));
+    result.push_back(mid);
+    result.push_back(median(above));
+    result.push_back(*max_element(above.begin(), above.end()));
+    return result;
+}
+
+
+#endif
@@ -23,9 +23,26 @@
 #include "globals.h"
 #include "agent.h"
 #include "device.h"
+#include "threadpool.h"
+#include "binaryio.h"
 
 using namespace std;
 
+/*
+ * Start a new day of history with the day totals of each block, one row
+ * of totals after the other.
+ */
+template <class T>
+static void appendDay(DailyHistory<T> &history, const vector<T> &totals)
+{
+    history.newDay();
+    const int rows = history.numRows();
+    for (int block = 0; block < history.numBlocks(); block++) {
+        copy(totals.begin() + block * rows, totals.begin() + (block + 1) * rows,
+             history.todayRow(block));
+    }
+}
+
 /**
  * DayExchangeStats constructor
  */
@@ -48,33 +65,56 @@ TradeStats::TradeStats()
 {
     resTradeVolume.clear();
     resTradeVolumeCrossGroup.clear();
-    resTradeVolumeByGroup.clear();
-    resTradeVolumeWithinGroup.clear();
 
     resTradeForDeviceVolume.clear();
-    resTradeForDeviceVolumeByGroup.clear();
     resTradeForDeviceVolumeCrossGroup.clear();
-    resTradeForDeviceVolumeWithinGroup.clear();
 
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        resTradeVolumeByGroup.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        resTradeVolumeWithinGroup.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        resTradeForDeviceVolumeByGroup.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        resTradeForDeviceVolumeWithinGroup.push_back(glob.EMPTY_VECTOR_OF_INTS);
-    }
+    // the trade volumes are only recorded with the full stats profile
+    int volumeDays = (glob.STATS_PROFILE == STATS_FULL) ? glob.NUM_DAYS : 0;
+    resTradeVolumeByGroup = DailyHistory<int>(1, glob.NUM_AGENT_GROUPS, volumeDays);
+    resTradeVolumeWithinGroup = DailyHistory<int>(1, glob.NUM_AGENT_GROUPS, volumeDays);
+    resTradeForDeviceVolumeByGroup = DailyHistory<int>(1, glob.NUM_AGENT_GROUPS, volumeDays);
+    resTradeForDeviceVolumeWithinGroup = DailyHistory<int>(1, glob.NUM_AGENT_GROUPS, volumeDays);
     if (glob.SAVE_TRADES) {
         dayResExchanges.clear();
         for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
             dayResExchanges.push_back(DayExchangeStats());
         }
-        resExchanges.clear();
+        resExchanges = DailyHistory<int>(2, glob.NUM_RESOURCES * glob.NUM_RESOURCES, glob.NUM_DAYS);
+        threadResExchanges = vector<vector<DayExchangeStats> >(glob.NUM_THREADS, dayResExchanges);
     }
 }
 
 /**
- * Update the information about trading.
+ * Update the information about trading.  The trade volumes are only
+ * recorded with the full stats profile (see stats_profile_t), the
+ * exchanges with SAVE_TRADES.
  */
 void TradeStats::dailyUpdate()
+{
+    if (glob.STATS_PROFILE == STATS_FULL) {
+        calcTradeVolumes();
+    }
+
+    if (glob.SAVE_TRADES) {
+        resExchanges.newDay();
+        int *sold = resExchanges.todayRow(0);
+        int *bought = resExchanges.todayRow(1);
+        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+            const vector<int> &soldFor = dayResExchanges[resId].getSoldExchanges();
+            const vector<int> &boughtFor = dayResExchanges[resId].getBoughtExchanges();
+            copy(soldFor.begin(), soldFor.end(), sold + resId * glob.NUM_RESOURCES);
+            copy(boughtFor.begin(), boughtFor.end(), bought + resId * glob.NUM_RESOURCES);
+            dayResExchanges[resId] = DayExchangeStats();  // reset for next time.
+        }
+    }
+}
+
+/**
+ * Append the day's resource trade volumes, in total, by group, across
+ * groups and within groups, to the histories.
+ */
+void TradeStats::calcTradeVolumes()
 {
     /*
      * For each agent add the units they sold.  Then append the total
@@ -94,10 +134,8 @@ void TradeStats::dailyUpdate()
     }
     resTradeVolume.push_back(tradeVolume);
     resTradeVolumeCrossGroup.push_back(tradeVolumeCrossGroup);
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        resTradeVolumeByGroup[gId].push_back(tradeVolumeByGroup[gId]);
-        resTradeVolumeWithinGroup[gId].push_back(tradeVolumeWithinGroup[gId]);
-    }
+    appendDay(resTradeVolumeByGroup, tradeVolumeByGroup);
+    appendDay(resTradeVolumeWithinGroup, tradeVolumeWithinGroup);
 
     /*
      * For each agent add up the number of units they sold for a device that day.
@@ -117,23 +155,8 @@ void TradeStats::dailyUpdate()
     }
     resTradeForDeviceVolume.push_back(tradeForDeviceVolume);
     resTradeForDeviceVolumeCrossGroup.push_back(tradeForDeviceVolumeCrossGroup);
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        resTradeForDeviceVolumeByGroup[gId].push_back(tradeForDeviceVolumeByGroup[gId]);
-        resTradeForDeviceVolumeWithinGroup[gId].push_back(tradeForDeviceVolumeWithinGroup[gId]);
-    }
-
-    if (glob.SAVE_TRADES) {
-        vector <vector <vector<int> > > newResExchanges;
-        vector <vector <int> > dayResExchTmp(2);	// 2 vectors of ints.
-        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            // push on two vectors of integers
-            dayResExchTmp[0] = dayResExchanges[resId].getSoldExchanges();
-            dayResExchTmp[1] = dayResExchanges[resId].getBoughtExchanges();
-            dayResExchanges[resId] = DayExchangeStats();  // reset for next time.
-            newResExchanges.push_back(dayResExchTmp);
-        }
-        resExchanges.push_back(newResExchanges);
-    }
+    appendDay(resTradeForDeviceVolumeByGroup, tradeForDeviceVolumeByGroup);
+    appendDay(resTradeForDeviceVolumeWithinGroup, tradeForDeviceVolumeWithinGroup);
 }
 
 /**
@@ -145,6 +168,13 @@ void TradeStats::newExchange(ResourcePair &pair)
     int resB = pair.getBPick();
     int numA = pair.getNumAPicked();
     int numB = pair.getNumBPicked();
+    /*
+     * Pairs trading on a worker thread write to that thread's own
+     * exchanges; see mergeThreadExchanges().
+     */
+    int thread = ThreadPool::threadIndex();
+    vector<DayExchangeStats> &dayResExchanges =
+        (thread == 0) ? this->dayResExchanges : threadResExchanges[thread];
     /*
      * dayResExchanges[resA].getSoldExchanges()[resB] is the number of units
      * of resA given up in exchange for resB.
@@ -158,477 +188,414 @@ void TradeStats::newExchange(ResourcePair &pair)
 }
 
 /**
- * ProductionStats constructor
+ * Add the exchanges recorded by the worker threads during a parallel
+ * trade round to dayResExchanges, and clear them.  Since the exchanges
+ * are only summed, the result does not depend on which thread ran which
+ * pair.
  */
-ProductionStats::ProductionStats()
+void TradeStats::mergeThreadExchanges()
 {
-    for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-        resGatheredByAgent.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        timeSpentGatheringWithoutDeviceByAgent.push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-    }
-    
-	for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-        numAgentsGatheringByRes.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        resGatheredByRes.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        resGatheredByResByAgent.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_INTS);
-        timeSpentGatheringWithoutDeviceByRes.push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-        for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-            resGatheredByResByAgent[resId].push_back(glob.EMPTY_VECTOR_OF_INTS);
-        }
-    }
-
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        resGatheredByGroup.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        devicesMadeByGroup.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_INTS);
-        timeSpentGatheringWithDeviceByGroup.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_DOUBLES);
-        timeSpentMakingDevicesByGroup.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_DOUBLES);
-        timeSpentGatheringWithoutDeviceByGroup.push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-        devicesMadeWithDevDeviceByGroup.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_INTS);
-		
-        for (int type = TOOL; type < glob.getNumDeviceTypes(); type++) {
-            devicesMadeByGroup[gId].push_back(glob.EMPTY_VECTOR_OF_INTS);
-            timeSpentGatheringWithDeviceByGroup[gId].push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-            timeSpentMakingDevicesByGroup[gId].push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-            devicesMadeWithDevDeviceByGroup[gId].push_back(glob.EMPTY_VECTOR_OF_INTS);
-        }
-    }
-
-    for (int type = TOOL; type < glob.getNumDeviceTypes(); type++) {
-        devicesMade.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        devicesMadeByRes.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_INTS);
-        /*
-         * For devicesMadeWithDevDevice & devicesMadeWithDevDeviceByRes:
-         * Put in place holder vectors.  At this point it is making 6 but we really only need two.
-         * In order to access the vectors with expected indexes (to simplify our lives), we chose
-         * to waste the four empty vectors at the beginning instead of needing to do offsets
-         * elsewhere to access the data correctly.
-         */
-        devicesMadeWithDevDevice.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        devicesMadeWithDevDeviceByRes.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_INTS);
-
-        timeSpentMakingDevices.push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-        timeSpentMakingDevicesByAgent.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_DOUBLES);
-        //JYC: added - 07.24.2018
-        timeSpentMakingDevicesByDeviceByRes.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_DOUBLES);
-//BRH 2018.07.17 -- eventually we may want to add an array to collect time spent making devices BY RES //
-
-        timeSpentGatheringWithDevice.push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-        timeSpentGatheringWithDeviceByAgent.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_DOUBLES);
-		timeSpentGatheringWithDeviceByRes.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_DOUBLES);
-        
-        // for each agent ID
-        for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-            timeSpentGatheringWithDeviceByAgent[type].push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-            timeSpentMakingDevicesByAgent[type].push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-        }
-
-        // for each resource ID
+    for (int thread = 1; thread < (int) threadResExchanges.size(); thread++) {
         for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            devicesMadeByRes[type].push_back(glob.EMPTY_VECTOR_OF_INTS);
-        }
-
-        // only types 0-3 (TOOL, MACHINE, FACTORY, INDUSTRY)
-        if (type <= INDUSTRY) {
-            resGatheredByDevice.push_back(glob.EMPTY_VECTOR_OF_INTS);
-			resGatheredByDeviceByRes.push_back(glob.EMPTY_VECTOR_OF_VECTORS_OF_INTS);
-            percentResGatheredByDevice.push_back(vector<double>());
-            percentResGatheredByDeviceByRes.push_back(vector<vector<double> >());
-
-            for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-                percentResGatheredByDeviceByRes[type].push_back(vector<double>());
-                resGatheredByDeviceByRes[type].push_back(glob.EMPTY_VECTOR_OF_INTS);
-                timeSpentGatheringWithDeviceByRes[type].push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-                timeSpentMakingDevicesByDeviceByRes[type].push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-            }
-        }
-        // only types 4-5 (DEVMACHINE, DEVFACTORY)
-        else if (type == DEVMACHINE || type == DEVFACTORY) {
-            for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-                devicesMadeWithDevDeviceByRes[type].push_back(glob.EMPTY_VECTOR_OF_INTS);
+            vector<int> sold = threadResExchanges[thread][resId].getSoldExchanges();
+            vector<int> bought = threadResExchanges[thread][resId].getBoughtExchanges();
+            for (int otherId = 0; otherId < glob.NUM_RESOURCES; otherId++) {
+                dayResExchanges[resId].addToSoldExchanges(otherId, sold[otherId]);
+                dayResExchanges[resId].addToBoughtExchanges(otherId, bought[otherId]);
             }
+            threadResExchanges[thread][resId] = DayExchangeStats();
         }
     }
 }
 
 /**
- * Update the information about production.
+ * Write the daily histories to a day status file.  The exchanges of the
+ * current day are not written: dailyUpdate() has just cleared them.
  */
-void ProductionStats::dailyUpdate()
+void TradeStats::saveState(ostream &out) const
 {
-    calcResGatheredAndResGatheredByAgentByGroup();
-    calcResGatheredByResByAgentAndNumAgentsGetheringByRes();
-    calcResGatheredByDevice();
-    calcResGatheredByDeviceByRes();
-    calcDevicesMade();
-    calcDevicesMadeByRes();
-    calcDevicesMadeWithDevDevicesByRes();
-    calcTimeSpentGatheringWithoutDevice();
-    calcTimeSpentGatheringWithDeviceAndTimeSpentMakingDevicesByAgent();
-    calcPercentResGatheredByDevice();
-    calcPercentResGatheredByDeviceByRes();
+    writeBinary(out, resTradeVolume);
+    resTradeVolumeByGroup.saveState(out);
+    writeBinary(out, resTradeVolumeCrossGroup);
+    resTradeVolumeWithinGroup.saveState(out);
+    writeBinary(out, resTradeForDeviceVolume);
+    resTradeForDeviceVolumeByGroup.saveState(out);
+    writeBinary(out, resTradeForDeviceVolumeCrossGroup);
+    resTradeForDeviceVolumeWithinGroup.saveState(out);
+    resExchanges.saveState(out);
 }
 
-
 /**
- * Calculate and update the sum of gathered resoures by all agents,
- *      the number of gathered resources by each agent,
- *      the sum of gathered resources by each group of agents on each day.
+ * Read back the histories written by saveState().
  */
-void ProductionStats::calcResGatheredAndResGatheredByAgentByGroup()
+void TradeStats::loadState(istream &in)
 {
-    /*
-     * Go through each agent and add up the amount of each resource that was gathered that day.
-     * This information will be added to lists by total of all agents and individually
-     */
-    int sumGathered = 0;
-    vector<int> temp = vector<int>(glob.NUM_AGENT_GROUPS, 0);   // index by type, today's unitsGathered by each type
-    for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-        int totalResThisAgentGathered = 0;
-        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            totalResThisAgentGathered += glob.agent[aId]->getUnitsGatheredToday(resId);
-        }
-        resGatheredByAgent[aId].push_back(totalResThisAgentGathered);
-        sumGathered += totalResThisAgentGathered;
-        temp[glob.agent[aId]->group] += totalResThisAgentGathered;
-    }
-    resGathered.push_back(sumGathered);
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        resGatheredByGroup[gId].push_back(temp[gId]);
-    }
+    readBinary(in, resTradeVolume);
+    resTradeVolumeByGroup.loadState(in);
+    readBinary(in, resTradeVolumeCrossGroup);
+    resTradeVolumeWithinGroup.loadState(in);
+    readBinary(in, resTradeForDeviceVolume);
+    resTradeForDeviceVolumeByGroup.loadState(in);
+    readBinary(in, resTradeForDeviceVolumeCrossGroup);
+    resTradeForDeviceVolumeWithinGroup.loadState(in);
+    resExchanges.loadState(in);
 }
 
 /**
- * Calculate and update the number of resources gathered for each resource by each agent,
- *     and the number of resources gathered for each resource by all agents.
+ * ProductionStats constructor
  */
-void ProductionStats::calcResGatheredByResByAgentAndNumAgentsGetheringByRes()
+ProductionStats::ProductionStats()
 {
+    const int numRes = glob.NUM_RESOURCES;
+    const int numGroups = glob.NUM_AGENT_GROUPS;
+    const int numTypes = NUM_DEVICE_TYPES;
+    const int numGatherTypes = NUM_RESOURCE_GATHERING_DEVICES;
     /*
-     * For every resource begin to go through and if see if an agent gathered any today.
-     * Add each amount gathered to sumResGathered
-     * Append each agents individual amount to the resGatheredByResByAgent
-     * If a resource was gathered by that agent add 1 to agentsMakingRes.
-     * After all agents have been checked for a given resource, append agentsMakingRes to numAgentsGatheringbyRes
-     * For each resource take the total gathered and append that to resGatheredByRes
+     * Each history is sized for NUM_DAYS days if the stats profile records
+     * it (see dailyUpdate()), and for none if not.  Below the full profile,
+     * which keeps them all, the histories of long_output keep the days of
+     * a row (see Utils::calcOutputRow()) and those of the other files saved
+     * at the end of a run the last day, which is all they are read for.
      */
-	 /* BRH 10.2.2017 testing */
-	bool DEBUG_PRODUCTIONSTATS = false;
-	 
-    for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-        int numAgentsGatheringRes = 0;
-        int totalAmountOfThisResGathered = 0;
-
-        for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-            int agentTotalThisResGathered =
-                glob.agent[aId]->getUnitsGatheredToday(resId);
-                resGatheredByResByAgent[resId][aId].push_back(agentTotalThisResGathered);
-                totalAmountOfThisResGathered += agentTotalThisResGathered;
-				if (agentTotalThisResGathered > 0) {
-                    numAgentsGatheringRes += 1;
-				}
-        }
-        numAgentsGatheringByRes[resId].push_back(numAgentsGatheringRes);
-        resGatheredByRes[resId].push_back(totalAmountOfThisResGathered);
-        if (DEBUG_PRODUCTIONSTATS) {
-            cout << "Day " << glob.currentDay+1 << " Total R" << resId+1 << " Gathered: "
-                 << totalAmountOfThisResGathered << endl;
-        }
-    }
+    const bool full = (glob.STATS_PROFILE == STATS_FULL);
+    int outputDays = full ? glob.NUM_DAYS : OUTPUT_WINDOW_DAYS;
+    int standardDays = full ? glob.NUM_DAYS : ((glob.STATS_PROFILE == STATS_STANDARD) ? 1 : 0);
+    int fullDays = full ? glob.NUM_DAYS : 0;
+
+    // those of long_output
+    resGathered = DailyHistory<int>(1, 1, outputDays, ! full);
+    resGatheredByDevice = DailyHistory<int>(1, numGatherTypes, outputDays, ! full);
+    devicesMade = DailyHistory<int>(1, numTypes, outputDays, ! full);
+    percentResGatheredByDevice = DailyHistory<double>(1, numGatherTypes, outputDays, ! full);
+
+    // those of the other files saved at the end of a run
+    resGatheredByRes = DailyHistory<int>(1, numRes, standardDays, ! full);
+    timeSpentGatheringWithoutDeviceByRes = DailyHistory<double>(1, numRes, standardDays, ! full);
+    devicesMadeByRes = DailyHistory<int>(numTypes, numRes, standardDays, ! full);
+    timeSpentGatheringWithDeviceByRes = DailyHistory<double>(numGatherTypes, numRes, standardDays, ! full);
+    //JYC: added - 07.24.2018
+    timeSpentMakingDevicesByDeviceByRes = DailyHistory<double>(numGatherTypes, numRes, standardDays, ! full);
+
+    // the rest
+    resGatheredByAgent = DailyHistory<int>(1, glob.NUM_AGENTS, fullDays);
+    resGatheredByResByAgent = DailyHistory<int>(numRes, glob.NUM_AGENTS, fullDays);
+    timeSpentGatheringWithoutDeviceByAgent = DailyHistory<double>(1, glob.NUM_AGENTS, fullDays);
+    timeSpentGatheringWithDeviceByAgent = DailyHistory<double>(numTypes, glob.NUM_AGENTS, fullDays);
+    timeSpentMakingDevicesByAgent = DailyHistory<double>(numTypes, glob.NUM_AGENTS, fullDays);
+
+    resGatheredByGroup = DailyHistory<int>(1, numGroups, fullDays);
+    timeSpentGatheringWithoutDeviceByGroup = DailyHistory<double>(1, numGroups, fullDays);
+    devicesMadeByGroup = DailyHistory<int>(numGroups, numTypes, fullDays);
+    timeSpentGatheringWithDeviceByGroup = DailyHistory<double>(numGroups, numTypes, fullDays);
+    timeSpentMakingDevicesByGroup = DailyHistory<double>(numGroups, numTypes, fullDays);
+
+    numAgentsGatheringByRes = DailyHistory<int>(1, numRes, fullDays);
+    timeSpentGatheringWithDevice = DailyHistory<double>(1, numTypes, fullDays);
+    timeSpentMakingDevices = DailyHistory<double>(1, numTypes, fullDays);
+    resGatheredByDeviceByRes = DailyHistory<int>(numGatherTypes, numRes, fullDays);
+    percentResGatheredByDeviceByRes = DailyHistory<double>(numGatherTypes, numRes, fullDays);
+
+    /*
+     * The devices made with devDevices are only counted for DEVMACHINE and
+     * DEVFACTORY, but the histories keep a value for every device type, so
+     * that they are indexed by device_name_t like the others.
+     */
+    devicesMadeWithDevDevice = DailyHistory<int>(1, numTypes, fullDays);
+    devicesMadeWithDevDeviceByRes = DailyHistory<int>(numTypes, numRes, fullDays);
+    devicesMadeWithDevDeviceByGroup = DailyHistory<int>(numGroups, numTypes, fullDays);
 }
 
 /**
- * Calculate and update the units gathered for all resourcess for each device.
+ * Write the daily histories to a day status file.
  */
-void ProductionStats::calcResGatheredByDevice()
+void ProductionStats::saveState(ostream &out) const
 {
-    /*
-     * We want to know the total amount of resources gathered by each device.
-     * For each device set sum=0
-     * Go through each agent look if they gathered with that device today.
-     * After going through all agents for a given device, add total to resGatheredByDevice
-     */
-
-    for (int tempType = TOOL; tempType <= INDUSTRY; tempType++) {
-        int sumGathered = 0;
-        for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-            for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-                sumGathered += glob.agent[aId]->getUnitsGatheredWithDevice(tempType, resId);
-            }
-        }
-        resGatheredByDevice[tempType].push_back(sumGathered);
-    }
+    resGathered.saveState(out);
+    resGatheredByAgent.saveState(out);
+    resGatheredByGroup.saveState(out);
+    numAgentsGatheringByRes.saveState(out);
+    resGatheredByRes.saveState(out);
+    resGatheredByResByAgent.saveState(out);
+    resGatheredByDevice.saveState(out);
+    resGatheredByDeviceByRes.saveState(out);
+    devicesMade.saveState(out);
+    devicesMadeByRes.saveState(out);
+    devicesMadeByGroup.saveState(out);
+    devicesMadeWithDevDevice.saveState(out);
+    devicesMadeWithDevDeviceByRes.saveState(out);
+    devicesMadeWithDevDeviceByGroup.saveState(out);
+    writeBinary(out, timeSpentGatheringWithoutDevice);
+    timeSpentGatheringWithoutDeviceByAgent.saveState(out);
+    timeSpentGatheringWithoutDeviceByGroup.saveState(out);
+    timeSpentGatheringWithoutDeviceByRes.saveState(out);
+    timeSpentGatheringWithDevice.saveState(out);
+    timeSpentGatheringWithDeviceByAgent.saveState(out);
+    timeSpentGatheringWithDeviceByGroup.saveState(out);
+    timeSpentGatheringWithDeviceByRes.saveState(out);
+    timeSpentMakingDevices.saveState(out);
+    timeSpentMakingDevicesByDeviceByRes.saveState(out);
+    timeSpentMakingDevicesByAgent.saveState(out);
+    timeSpentMakingDevicesByGroup.saveState(out);
+    percentResGatheredByDevice.saveState(out);
+    percentResGatheredByDeviceByRes.saveState(out);
 }
 
 /**
- * Calculate and update the units gathered by each device for each resource.
+ * Read back the histories written by saveState().
  */
-void ProductionStats::calcResGatheredByDeviceByRes()
+void ProductionStats::loadState(istream &in)
 {
-    /*
-     * We want to know which devices are gathering how much of each resource.
-     *
-     *	Rearranged for resId line and the for type lines
-     *		- We did this because when we need to push_back vectors the correct number of vectors.
-     *		- Type gets called first before resId.  The flip flop makes sense.
-     */
-    string devicesStr[] = { "T1", "T2", "T3", "T4" };
-    for (int type = 0; type < glob.getNumResGatherDev(); type++) {
-        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            int sumGathered = 0;
-            for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-                sumGathered += glob.agent[aId]->getUnitsGatheredWithDevice(type, resId);
-            }
-            resGatheredByDeviceByRes[type][resId].push_back(sumGathered);
-            if (DEBUG_PRODUCTIONSTATS) {
-                cout <<  devicesStr[type] << " for R" << resId+1 << " Gathered " << sumGathered << endl;
-            }
-        }
-    }
+    resGathered.loadState(in);
+    resGatheredByAgent.loadState(in);
+    resGatheredByGroup.loadState(in);
+    numAgentsGatheringByRes.loadState(in);
+    resGatheredByRes.loadState(in);
+    resGatheredByResByAgent.loadState(in);
+    resGatheredByDevice.loadState(in);
+    resGatheredByDeviceByRes.loadState(in);
+    devicesMade.loadState(in);
+    devicesMadeByRes.loadState(in);
+    devicesMadeByGroup.loadState(in);
+    devicesMadeWithDevDevice.loadState(in);
+    devicesMadeWithDevDeviceByRes.loadState(in);
+    devicesMadeWithDevDeviceByGroup.loadState(in);
+    readBinary(in, timeSpentGatheringWithoutDevice);
+    timeSpentGatheringWithoutDeviceByAgent.loadState(in);
+    timeSpentGatheringWithoutDeviceByGroup.loadState(in);
+    timeSpentGatheringWithoutDeviceByRes.loadState(in);
+    timeSpentGatheringWithDevice.loadState(in);
+    timeSpentGatheringWithDeviceByAgent.loadState(in);
+    timeSpentGatheringWithDeviceByGroup.loadState(in);
+    timeSpentGatheringWithDeviceByRes.loadState(in);
+    timeSpentMakingDevices.loadState(in);
+    timeSpentMakingDevicesByDeviceByRes.loadState(in);
+    timeSpentMakingDevicesByAgent.loadState(in);
+    timeSpentMakingDevicesByGroup.loadState(in);
+    percentResGatheredByDevice.loadState(in);
+    percentResGatheredByDeviceByRes.loadState(in);
 }
 
 /**
- * Looking to identify how many of each type of device was made today.
- * For each type in devicesMade, set made =0 and look in agent
- * Set the sum of each agent =0 and look at the each resource for each agent
- * If they invented that device for that resource add that to agent tempSum
- * After all resources have been checked for that device and that agent add the total to made
- * Once all agents have been checked append made to the devicesMade list for the given device
+ * Update the information about production.
+ *
+ * One pass over the agents adds what each of them did today into flat
+ * day totals (indexed [res], [type * NUM_RESOURCES + res],
+ * [group * NUM_DEVICE_TYPES + type]), whose inner loops run over the
+ * contiguous rows of the agent, and the totals are then appended to the
+ * histories.  The values of each agent go straight into today's rows of
+ * the per-agent histories.  Only the histories of the stats profile are
+ * recorded (see stats_profile_t); the others stay empty.  Each sum of
+ * doubles still adds the agents in order, so the totals come out to the
+ * same bits as when each statistic had its own loop over the agents.
  */
-void ProductionStats::calcDevicesMade()
+void ProductionStats::dailyUpdate()
 {
-    vector<vector<int> > temp;  //*< indexed by agent type, then device type */
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        temp.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        temp[gId] = vector<int>(glob.getNumDeviceTypes(), 0);
+    const int numRes = glob.NUM_RESOURCES;
+    const int numGroups = glob.NUM_AGENT_GROUPS;
+    const int numTypes = NUM_DEVICE_TYPES;
+    const int numGatherTypes = NUM_RESOURCE_GATHERING_DEVICES;
+
+    int sumGathered = 0;
+    vector<int> gatheredByGroup(numGroups, 0);
+    vector<int> gatheredByRes(numRes, 0);
+    vector<int> agentsGatheringByRes(numRes, 0);
+    vector<int> gatheredByDeviceByRes(numGatherTypes * numRes, 0);
+    vector<int> madeByRes(numTypes * numRes, 0);
+    vector<int> madeByGroup(numGroups * numTypes, 0);
+    vector<int> madeWithDevDeviceByRes(numTypes * numRes, 0);
+    vector<int> madeWithDevDeviceByGroup(numGroups * numTypes, 0);
+
+    double timeWithoutDevice = 0.0;
+    vector<double> timeWithoutDeviceByGroup(numGroups, 0.0);
+    vector<double> timeWithoutDeviceByRes(numRes, 0.0);
+    vector<double> timeWithDevice(numTypes, 0.0);
+    vector<double> timeWithDeviceByGroup(numGroups * numTypes, 0.0);
+    vector<double> timeWithDeviceByRes(numGatherTypes * numRes, 0.0);
+    vector<double> timeMaking(numTypes, 0.0);
+    vector<double> timeMakingByGroup(numGroups * numTypes, 0.0);
+    vector<double> timeMakingByDeviceByRes(numGatherTypes * numRes, 0.0);
+
+    const bool standard = (glob.STATS_PROFILE >= STATS_STANDARD);
+    const bool full = (glob.STATS_PROFILE == STATS_FULL);
+    int *gatheredByAgent = NULL;
+    double *timeWithoutDeviceByAgent = NULL;
+    if (full) {
+        resGatheredByAgent.newDay();
+        resGatheredByResByAgent.newDay();
+        timeSpentGatheringWithoutDeviceByAgent.newDay();
+        timeSpentGatheringWithDeviceByAgent.newDay();
+        timeSpentMakingDevicesByAgent.newDay();
+        gatheredByAgent = resGatheredByAgent.todayRow();
+        timeWithoutDeviceByAgent = timeSpentGatheringWithoutDeviceByAgent.todayRow();
     }
 
-    for (int type = 0; type < glob.getNumDeviceTypes(); type++) {
-        int tempDevicesMade = 0;
-        for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-            int tempSum = 0;
-            for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-                tempSum += glob.agent[aId]->devProp[type][resId].devicesMadeToday;
+    for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
+        const Agent *ag = glob.agent[aId];
+        const int group = ag->group;
+
+        /* units gathered, by resource and by device */
+        int agentGathered = 0;
+        for (int resId = 0; resId < numRes; resId++) {
+            int units = ag->resProp[resId].unitsGatheredToday;
+            if (full) {
+                resGatheredByResByAgent.todayRow(resId)[aId] = units;
             }
-            tempDevicesMade += tempSum;
-            temp[glob.agent[aId]->group][type] += tempSum;
+            agentGathered += units;
+            gatheredByRes[resId] += units;
+            agentsGatheringByRes[resId] += (units > 0);
         }
-        devicesMade[type].push_back(tempDevicesMade);
-    }
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        for (int type = 0; type < glob.getNumDeviceTypes(); type++) {
-            devicesMadeByGroup[gId][type].push_back(temp[gId][type]);
+        if (full) {
+            gatheredByAgent[aId] = agentGathered;
         }
-    }
-}
-
-/**
- * Similar process but now answering the question:  How many of a certain
- * device has been made for a given resource. 
- */
-void ProductionStats::calcDevicesMadeByRes()
-{
-    for (int type = 0; type < glob.getNumDeviceTypes(); type++) {
-        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            int tempMade = 0;
-            for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-                tempMade += glob.agent[aId]->getDevicesMadeToday(resId, type);
+        sumGathered += agentGathered;
+        gatheredByGroup[group] += agentGathered;
+        for (int type = 0; type < numGatherTypes; type++) {
+            const int *units = &ag->unitsGatheredWithDeviceToday[type][0];
+            int *total = &gatheredByDeviceByRes[type * numRes];
+            for (int resId = 0; resId < numRes; resId++) {
+                total[resId] += units[resId];
             }
-            devicesMadeByRes[type][resId].push_back(tempMade);
-            if (DEBUG_PRODUCTIONSTATS) {
-                    cout << tempMade << " " << type << "made for R" << resId << endl;
-                }
         }
-    }
-}
 
-/**
- * This calculated the number of devices made by device making devices.
- * We want to know the total of devDevices made and the total devDevices
- * made for each resource.
- */
-void ProductionStats::calcDevicesMadeWithDevDevicesByRes()
-{
-    vector<vector<int> > temp;  //*< indexed by agent type, then device type */
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        temp.push_back(glob.EMPTY_VECTOR_OF_INTS);
-        temp[gId] = vector<int>(2, 0);  // only DEVMACHINE and DEVFACTORY;
-    }
-    for (int type = DEVMACHINE; type <= DEVFACTORY; type++) {
-        int devMadeWithDevice = 0;
-        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            // this gets reset for each resource and set the inner vector
-            int devMadeWithDeviceByRes = 0;
-            for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-                // The next two lines look up the same thing, but one will
-                // be adding for each type and the other is adding for each
-                // type and resource.
-                devMadeWithDeviceByRes +=
-                    glob.agent[aId]->devicesMadeWithDevDevicesToday[type][resId];
-                devMadeWithDevice +=
-                    glob.agent[aId]->devicesMadeWithDevDevicesToday[type][resId];
-                temp[glob.agent[aId]->group][type-4] += glob.agent[aId]->devicesMadeWithDevDevicesToday[type][resId];
-
-               // BRH testing 05.27.2018  if (DEBUG_PRODUCTIONSTATS) {
-                //    cout << "Devices Made With DevDevice:  Type: " << type
-                //         << "  resID: " << resId << endl;
-                //    cout << "devMadeWithDeviceByRes   Type: " << type
-                //         << "  resID: " << resId << endl;
-                //    cout << "devMadeWithDevice   Type: " << type
-                //         << "  resID: " << resId << endl;
-                //    cout << "agentID: " << aId << "  resID: " << resId
-                //         << " type: " << type << endl;
-               // }
+        /* devices made, and devices made with device-making devices */
+        for (int type = 0; type < numTypes; type++) {
+            const vector<DevProperties> &thisDev = ag->devProp[type];
+            int *total = &madeByRes[type * numRes];
+            int agentMade = 0;
+            for (int resId = 0; resId < numRes; resId++) {
+                total[resId] += thisDev[resId].devicesMadeToday;
+                agentMade += thisDev[resId].devicesMadeToday;
             }
-            devicesMadeWithDevDeviceByRes[type][resId].push_back(devMadeWithDeviceByRes);
+            madeByGroup[group * numTypes + type] += agentMade;
         }
-        devicesMadeWithDevDevice[type].push_back(devMadeWithDevice);
-    }
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        for (int type =DEVMACHINE; type <= DEVFACTORY; type++) {
-            devicesMadeWithDevDeviceByGroup[gId][type].push_back(temp[gId][type]);
+        for (int type = DEVMACHINE; type <= DEVFACTORY; type++) {
+            const int *made = &ag->devicesMadeWithDevDevicesToday[type][0];
+            int *total = &madeWithDevDeviceByRes[type * numRes];
+            int agentMade = 0;
+            for (int resId = 0; resId < numRes; resId++) {
+                total[resId] += made[resId];
+                agentMade += made[resId];
+            }
+            madeWithDevDeviceByGroup[group * numTypes + type] += agentMade;
         }
-    }
-}
-
 
-/**
- * The goal is to save the time each agent spent gathering without devices
- * and the amount of time society spent gathering without devices.
- */
-void ProductionStats::calcTimeSpentGatheringWithoutDevice()
-{
-	double timeWithoutDeviceTotal;
-    vector<double> temp = vector<double>(glob.NUM_AGENT_GROUPS, 0);
-    double timeWithoutDeviceResTotal;
-    for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-        double timeWithoutDeviceEachAgent = glob.agent[aId]->timeSpentGatheringWithoutDeviceToday;
-        timeWithoutDeviceTotal += timeWithoutDeviceEachAgent;
-        timeSpentGatheringWithoutDeviceByAgent[aId].push_back(timeWithoutDeviceEachAgent);
-        temp[glob.agent[aId]->group] += timeWithoutDeviceEachAgent;
-        timeWithoutDeviceEachAgent = 0;
-        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            timeWithoutDeviceResTotal = 0;
-            double timeWithoutDeviceByResEachAgent = glob.agent[aId]->timeSpentGatheringWithoutDeviceTodayByRes[resId];
-            timeWithoutDeviceResTotal += timeWithoutDeviceByResEachAgent;
+        /* time gathering without and with devices, and making devices */
+        timeWithoutDevice += ag->timeSpentGatheringWithoutDeviceToday;
+        if (full) {
+            timeWithoutDeviceByAgent[aId] = ag->timeSpentGatheringWithoutDeviceToday;
+        }
+        timeWithoutDeviceByGroup[group] += ag->timeSpentGatheringWithoutDeviceToday;
+        const double *timeByRes = &ag->timeSpentGatheringWithoutDeviceTodayByRes[0];
+        for (int resId = 0; resId < numRes; resId++) {
+            timeWithoutDeviceByRes[resId] += timeByRes[resId];
+        }
+        for (int type = 0; type < numTypes; type++) {
+            double gathering = ag->timeSpentGatheringWithDeviceToday[type];
+            double making = ag->timeSpentMakingDevicesToday[type];
+            timeWithDevice[type] += gathering;
+            timeMaking[type] += making;
+            if (full) {
+                timeSpentGatheringWithDeviceByAgent.todayRow(type)[aId] = gathering;
+                timeSpentMakingDevicesByAgent.todayRow(type)[aId] = making;
+            }
+            timeWithDeviceByGroup[group * numTypes + type] += gathering;
+            timeMakingByGroup[group * numTypes + type] += making;
+        }
+        for (int type = 0; type < numGatherTypes; type++) {
+            const double *gathering = &ag->timeSpentGatheringWithDeviceTodayByRes[type][0];
+            const double *making = &ag->timeSpentMakingDevicesTodayByDeviceByRes[type][0];
+            double *gatheringTotal = &timeWithDeviceByRes[type * numRes];
+            double *makingTotal = &timeMakingByDeviceByRes[type * numRes];
+            for (int resId = 0; resId < numRes; resId++) {
+                gatheringTotal[resId] += gathering[resId];
+                makingTotal[resId] += making[resId];
+            }
         }
-        timeSpentGatheringWithoutDevice.push_back(timeWithoutDeviceTotal);
-    }
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        timeSpentGatheringWithoutDeviceByGroup[gId].push_back(temp[gId]);
     }
-}
-
 
-/**
- * This keeps 4 statistics:
- * Amount of time each agent spends gathering resources with a device
- * Amount of time the population spends gathering resources with a device
- * Amount of time each agent spends making devices
- * Amount of time the population spends making devices
- */
-//JYC: 07.31.2018
-void ProductionStats::calcTimeSpentGatheringWithDeviceAndTimeSpentMakingDevicesByAgent()
-{
-    /* NOTE: python code only computes timeSpentGathering* for TOOL
-     * -> INDUSTRY, not the last two.  This code does not make that
-     * distinction. So be careful when using it in save data.
-     */
-    vector<vector<double> > tempTimeSpentGathering, tempTimeSpentMaking;  	//*< indexed by agent type, then device type */
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        tempTimeSpentGathering.push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-        tempTimeSpentGathering[gId] = vector<double>(glob.getNumDeviceTypes(), 0);
-
-        tempTimeSpentMaking.push_back(glob.EMPTY_VECTOR_OF_DOUBLES);
-        tempTimeSpentMaking[gId] = vector<double>(glob.getNumDeviceTypes(), 0);
+    /* Append the day totals to the histories: first those of long_output. */
+    resGathered.newDay();
+    resGathered.todayRow()[0] = sumGathered;
+    vector<int> made(numTypes, 0);
+    for (int type = 0; type < numTypes; type++) {
+        for (int resId = 0; resId < numRes; resId++) {
+            made[type] += madeByRes[type * numRes + resId];
+        }
     }
-
-    for (int type = 0; type < glob.getNumDeviceTypes(); type++) {
-    	double totalTimeSpentGatheringWithDevice = 0;
-        double totalTimeSpentMakingDevices = 0;
-        for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-            // Grab the amount of time this agent spent gathering
-            // with/making devices for this type. 
-            double timeMakingDevicesByAgent = glob.agent[aId]->timeSpentMakingDevicesToday[type];
-            double timeGatheringWithDeviceByAgent = glob.agent[aId]->timeSpentGatheringWithDeviceToday[type];
-            
-            // add this agents time spent with the previous agents
-            totalTimeSpentGatheringWithDevice += timeGatheringWithDeviceByAgent;
-            totalTimeSpentMakingDevices += timeMakingDevicesByAgent;
-
-            // save this individual agent's time data in a vector.
-            timeSpentMakingDevicesByAgent[type][aId].push_back(timeMakingDevicesByAgent);
-            //JYC: added - 07.24.2018
-            timeSpentGatheringWithDeviceByAgent[type][aId].push_back(timeGatheringWithDeviceByAgent);
-
-            tempTimeSpentGathering[glob.agent[aId]->group][type] += timeGatheringWithDeviceByAgent;
-            tempTimeSpentMaking[glob.agent[aId]->group][type] += timeMakingDevicesByAgent;
+    appendDay(devicesMade, made);
+    vector<int> gatheredByDevice(numGatherTypes, 0);
+    for (int type = 0; type < numGatherTypes; type++) {
+        for (int resId = 0; resId < numRes; resId++) {
+            gatheredByDevice[type] += gatheredByDeviceByRes[type * numRes + resId];
         }
-        // save the time data of the population as a whole.
-        timeSpentGatheringWithDevice[type].push_back(totalTimeSpentGatheringWithDevice);
-        timeSpentMakingDevices[type].push_back(totalTimeSpentMakingDevices);
     }
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        for (int type = 0; type < glob.getNumDeviceTypes(); type++) {
-            timeSpentGatheringWithDeviceByGroup[gId][type].push_back(tempTimeSpentGathering[gId][type]);
-            timeSpentMakingDevicesByGroup[gId][type].push_back(tempTimeSpentMaking[gId][type]);
+    appendDay(resGatheredByDevice, gatheredByDevice);
+    for (int resId = 0; resId < numRes; resId++) {
+        if (DEBUG_PRODUCTIONSTATS) {
+            cout << "Day " << glob.currentDay+1 << " Total R" << resId+1 << " Gathered: "
+                 << gatheredByRes[resId] << endl;
         }
     }
-// BRH New 07.17.2018 Save the time used to gather each resource: by hand, and then by each device tier.
-
-    for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-    	double totalTimeWithoutDeviceByRes = 0;
-    	for (int aId = 0; aId < glob.NUM_AGENTS; aId++){
-    		double timeWithoutDeviceByRes = glob.agent[aId] -> getTimeSpentGatheringWithoutDeviceTodayByRes(resId);
-    		totalTimeWithoutDeviceByRes += timeWithoutDeviceByRes;
-    	}
-    	timeSpentGatheringWithoutDeviceByRes[resId].push_back(totalTimeWithoutDeviceByRes);
-	}
-
-	 for (int type = 0; type < glob.getNumResGatherDev(); type++) {
-    	for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-    	double totalTimeWithDeviceByRes = 0;
-    	for (int aId = 0; aId < glob.NUM_AGENTS; aId++){
-    		double timeWithDeviceByRes = glob.agent[aId] -> getTimeSpentGatheringWithDeviceTodayByRes(type,resId);
-    		totalTimeWithDeviceByRes += timeWithDeviceByRes;
-    	}
-    	timeSpentGatheringWithDeviceByRes[type][resId].push_back(totalTimeWithDeviceByRes);
-    	}
-     }
-
-	 //JYC: added - 07.24.2018
-	 for (int type = 0; type < glob.getNumResGatherDev(); type++) {
-		for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-    	double totalTimeSpentMakingDevicesByDeviceByRes = 0;
-    	for (int aId = 0; aId < glob.NUM_AGENTS; aId++){
-    		double timeMakingEachDeviceByRes = glob.agent[aId] -> getTimeSpentMakingDevicesTodayByDeviceByRes(type,resId);
-    		totalTimeSpentMakingDevicesByDeviceByRes += timeMakingEachDeviceByRes;
-    	}
-    	timeSpentMakingDevicesByDeviceByRes[type][resId].push_back(totalTimeSpentMakingDevicesByDeviceByRes);
-    	}
-     }
+    calcPercentResGatheredByDevice();
 
+    /* Then those of the other files saved at the end of a run. */
+    if (standard) {
+        appendDay(resGatheredByRes, gatheredByRes);
+        appendDay(timeSpentGatheringWithoutDeviceByRes, timeWithoutDeviceByRes);
+        appendDay(devicesMadeByRes, madeByRes);
+        appendDay(timeSpentGatheringWithDeviceByRes, timeWithDeviceByRes);
+        appendDay(timeSpentMakingDevicesByDeviceByRes, timeMakingByDeviceByRes);
+    }
+
+    /* Then the rest. */
+    if (full) {
+        timeSpentGatheringWithoutDevice.push_back(timeWithoutDevice);
+        appendDay(resGatheredByGroup, gatheredByGroup);
+        appendDay(timeSpentGatheringWithoutDeviceByGroup, timeWithoutDeviceByGroup);
+        appendDay(devicesMadeByGroup, madeByGroup);
+        appendDay(timeSpentGatheringWithDeviceByGroup, timeWithDeviceByGroup);
+        appendDay(timeSpentMakingDevicesByGroup, timeMakingByGroup);
+        appendDay(devicesMadeWithDevDeviceByGroup, madeWithDevDeviceByGroup);
+        appendDay(numAgentsGatheringByRes, agentsGatheringByRes);
+        appendDay(timeSpentGatheringWithDevice, timeWithDevice);
+        appendDay(timeSpentMakingDevices, timeMaking);
+        vector<int> madeWithDevDevice(numTypes, 0);
+        for (int type = DEVMACHINE; type <= DEVFACTORY; type++) {
+            for (int resId = 0; resId < numRes; resId++) {
+                madeWithDevDevice[type] += madeWithDevDeviceByRes[type * numRes + resId];
+            }
+        }
+        appendDay(devicesMadeWithDevDevice, madeWithDevDevice);
+        appendDay(devicesMadeWithDevDeviceByRes, madeWithDevDeviceByRes);
+        appendDay(resGatheredByDeviceByRes, gatheredByDeviceByRes);
+        calcPercentResGatheredByDeviceByRes();
+    }
 }
 
+
 /**
  * Of all the resources gathered what percent of them were gathered with a device?
  */
 void ProductionStats::calcPercentResGatheredByDevice()
 {
+    percentResGatheredByDevice.newDay();
+    double *percent = percentResGatheredByDevice.todayRow();
+    const int *gatheredByDevice = resGatheredByDevice.todayRow();
+    const int gathered = resGathered.todayRow()[0];
     // Used enums because the resGatheredByDevice is only filled with the first 4.
     // Agent class does not fill vector indexes 5 and 6.
     for (int type = TOOL; type <= INDUSTRY; type++) {
         if (DEBUG_PRODUCTIONSTATS) {
             cout << "Device type: " << type << endl;
         }
-        double percentGathered = double(resGatheredByDevice[type].back()) / double(resGathered.back());
+        percent[type] = double(gatheredByDevice[type]) / double(gathered);
 
-        percentResGatheredByDevice[type].push_back(percentGathered);
         if (DEBUG_PRODUCTIONSTATS) {
             cout << "ResGatheredByDevice for type: " << type << " =  "
-                 << resGatheredByDevice[type].back() << endl;
+                 << gatheredByDevice[type] << endl;
         }
         if (DEBUG_PRODUCTIONSTATS) {
-            cout << "ResGathered =  " << resGathered.back() << endl;
+            cout << "ResGathered =  " << gathered << endl;
         }
 
     }
@@ -640,20 +607,23 @@ void ProductionStats::calcPercentResGatheredByDevice()
  */
 void ProductionStats::calcPercentResGatheredByDeviceByRes()
 {
+    percentResGatheredByDeviceByRes.newDay();
+    const int *gatheredByRes = resGatheredByRes.todayRow();
     for (int type = TOOL; type <= INDUSTRY; type++) {
+        const int *gatheredByDevice = resGatheredByDeviceByRes.todayRow(type);
+        double *percent = percentResGatheredByDeviceByRes.todayRow(type);
         for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
             double percentGatheredBDBR = 0;
-            if (resGatheredByRes[resId].back() > 0) {
-                percentGatheredBDBR = double(resGatheredByDeviceByRes[type][resId].back()) /
-                    (resGatheredByRes[resId].back());
-                percentResGatheredByDeviceByRes[type][resId].push_back(percentGatheredBDBR);
+            if (gatheredByRes[resId] > 0) {
+                percentGatheredBDBR = double(gatheredByDevice[resId]) / (gatheredByRes[resId]);
+                percent[resId] = percentGatheredBDBR;
                 if (DEBUG_PRODUCTIONSTATS) {
                     cout << "% of res " << resId << "gathered by device "
                          << type << " : " << endl;
                 }
 
             } else {
-                percentResGatheredByDeviceByRes[type][resId].push_back(0.0);
+                percent[resId] = 0.0;
             }
         }
     }
@@ -676,42 +646,80 @@ void ProductionStats::calcPercentResGatheredByDeviceByRes()
  */
 OtherStats::OtherStats()
 {
-    activeAgents = vector<int>();
-    sumRes = vector<int>();
-    for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-        sumResByAgent.push_back(vector<int>());
-    }
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        sumResByGroup.push_back(vector<int>());
-        activeGroupAgents.push_back(vector<int>());
-    }
+    /*
+     * The histories by group, and sumResByAgent, are only recorded with the
+     * full stats profile; the others are read for long_output, and only
+     * the full profile keeps more than the days of a row of it.
+     */
+    const bool full = (glob.STATS_PROFILE == STATS_FULL);
+    int outputDays = full ? glob.NUM_DAYS : OUTPUT_WINDOW_DAYS;
+    int fullDays = full ? glob.NUM_DAYS : 0;
+    activeAgents = DailyHistory<int>(1, 1, outputDays, ! full);
+    activeGroupAgents = DailyHistory<int>(1, glob.NUM_AGENT_GROUPS, fullDays);
+    sumRes = DailyHistory<int>(1, 1, outputDays, ! full);
+    sumResByAgent = DailyHistory<int>(1, glob.NUM_AGENTS, fullDays);
+    sumResByGroup = DailyHistory<int>(1, glob.NUM_AGENT_GROUPS, fullDays);
+
+    sumUtil = DailyHistory<double>(1, 1, outputDays, ! full);
+    sumUtilByAgent = DailyHistory<double>(1, glob.NUM_AGENTS, outputDays, ! full);
+    sumUtilByGroup = DailyHistory<double>(1, glob.NUM_AGENT_GROUPS, fullDays);
+
+    numberOfInventedDevices = DailyHistory<int>(1, glob.getNumDeviceTypes(), fullDays);
+}
 
-    sumUtil = vector<double>();
-    for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-        sumUtilByAgent.push_back(vector<double>());
-    }
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        sumUtilByGroup.push_back(vector<double>());
-    }
+/**
+ * Write the daily histories to a day status file.
+ */
+void OtherStats::saveState(ostream &out) const
+{
+    activeAgents.saveState(out);
+    activeGroupAgents.saveState(out);
+    sumRes.saveState(out);
+    sumResByAgent.saveState(out);
+    sumResByGroup.saveState(out);
+    sumUtil.saveState(out);
+    sumUtilByAgent.saveState(out);
+    sumUtilByGroup.saveState(out);
+    numberOfInventedDevices.saveState(out);
+    outputRows.saveState(out);
+}
 
-    for (int i = 0; i < glob.getNumDeviceTypes(); i++) {
-        numberOfInventedDevices.push_back(glob.EMPTY_VECTOR_OF_INTS);
-    }
+/**
+ * Read back the histories written by saveState().
+ */
+void OtherStats::loadState(istream &in)
+{
+    activeAgents.loadState(in);
+    activeGroupAgents.loadState(in);
+    sumRes.loadState(in);
+    sumResByAgent.loadState(in);
+    sumResByGroup.loadState(in);
+    sumUtil.loadState(in);
+    sumUtilByAgent.loadState(in);
+    sumUtilByGroup.loadState(in);
+    numberOfInventedDevices.loadState(in);
+    outputRows.loadState(in);
 }
 
 /**
  * Calls functions to handle updating of resource stats, total utility,
- * statistics about devices in existence.
+ * statistics about devices in existence.  Only the active agents and the
+ * totals of the resources held and of the utility are recorded for
+ * long_output; the rest only with the full stats profile (see
+ * stats_profile_t).
  */
 void OtherStats::dailyUpdate()
 {
-    activeAgents.push_back(glob.activeAgents);		// For saving results and graphing.
-    for (int i = 0; i < glob.NUM_AGENT_GROUPS; i++) {
-        activeGroupAgents[i].push_back(glob.NUM_ACTIVE_AGENTS_IN_GROUP[i]);
+    activeAgents.newDay();
+    activeAgents.todayRow()[0] = glob.activeAgents;		// For saving results and graphing.
+    if (glob.STATS_PROFILE == STATS_FULL) {
+        appendDay(activeGroupAgents, glob.NUM_ACTIVE_AGENTS_IN_GROUP);
     }
     calcSumResourcesByAgentByGroup();
     calcSumUtility();
-    calcNumDevicesInvented();
+    if (glob.STATS_PROFILE == STATS_FULL) {
+        calcNumDevicesInvented();
+    }
 }
 
 /**
@@ -724,24 +732,34 @@ void OtherStats::calcSumResourcesByAgentByGroup()
     }
 
     int sumResources = 0;
+    const bool full = (glob.STATS_PROFILE == STATS_FULL);
     vector<int> temp = vector<int>(glob.NUM_AGENT_GROUPS, 0);
+    int *heldByAgent = NULL;
+    if (full) {
+        sumResByAgent.newDay();
+        heldByAgent = sumResByAgent.todayRow();
+    }
     for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
         int totalHeldByThisAgent = 0;
+        const int *heldByThisAgent = glob.agentState.heldRow(aId);
         for (int resP = 0; resP < glob.NUM_RESOURCES; resP++) {
             if (DEBUG_OTHERSTATS) {
                 cout << "[statsTracker.cpp] OtherStats() - getting NumResources, aId = "
                      << aId << " resId = " << resP << endl;
             }
 
-            totalHeldByThisAgent += glob.agent[aId]->getHeld(resP);
+            totalHeldByThisAgent += heldByThisAgent[resP];
+        }
+        if (full) {
+            heldByAgent[aId] = totalHeldByThisAgent;
         }
-        sumResByAgent[aId].push_back(totalHeldByThisAgent);
         sumResources += totalHeldByThisAgent;
         temp[glob.agent[aId]->group] += totalHeldByThisAgent;
     }
-    sumRes.push_back(sumResources);
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        sumResByGroup[gId].push_back(temp[gId]);
+    sumRes.newDay();
+    sumRes.todayRow()[0] = sumResources;
+    if (full) {
+        appendDay(sumResByGroup, temp);
     }
     if (ENTER_EXIT_METHODS) {
         cout << "[statsTracker.cpp] OtherStats() - Exit" << endl;
@@ -756,16 +774,19 @@ void OtherStats::calcSumUtility()
 {
     double sumUtility = 0;
     vector<double> sumUtilityByGroup = vector<double>(glob.NUM_AGENT_GROUPS, 0.0);
+    sumUtilByAgent.newDay();
+    double *utilityByAgent = sumUtilByAgent.todayRow();
     for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
         int agentUtility = 0;
         agentUtility = glob.agent[aId]->utilityToday;
-        sumUtilByAgent[aId].push_back(agentUtility);
+        utilityByAgent[aId] = agentUtility;
         sumUtilityByGroup[glob.agent[aId]->group] += agentUtility;
         sumUtility += agentUtility;
     }
-    sumUtil.push_back(sumUtility);
-    for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
-        sumUtilByGroup[gId].push_back(sumUtilityByGroup[gId]);
+    sumUtil.newDay();
+    sumUtil.todayRow()[0] = sumUtility;
+    if (glob.STATS_PROFILE == STATS_FULL) {
+        appendDay(sumUtilByGroup, sumUtilityByGroup);
     }
 }
 
@@ -774,25 +795,25 @@ void OtherStats::calcSumUtility()
  */
 void OtherStats::calcNumDevicesInvented()
 {
+    numberOfInventedDevices.newDay();
+    int *knownDevices = numberOfInventedDevices.todayRow();
     for (int i = 0; i < glob.getNumDeviceTypes(); i++) {
-        int knownDevices = 0;
         for (int j = 0; j < glob.NUM_RESOURCES; j++) {
             if ((glob.discoveredDevices[i][j] != 0)
                 && (glob.discoveredDevices[i][j]->agentsKnown() != 0)) {
-                knownDevices += 1;
+                knownDevices[i] += 1;
             }
         }
-        numberOfInventedDevices[i].push_back(knownDevices);
     }
 
     if (DEBUG) {
         cout << "Number of Invented Devices (By Type, By Day): ";
-        cout << "TOOL: " << numberOfInventedDevices[0].back() << ", ";
-        cout << "MACHINE: " << numberOfInventedDevices[1].back() << ", ";
-        cout << "FACTORY: " << numberOfInventedDevices[2].back() << ", ";
-        cout << "INDUSTRY: " << numberOfInventedDevices[3].back() << ", ";
-        cout << "DEVMACHINE: " << numberOfInventedDevices[4].back() << ", ";
-        cout << "DEVFACTORY: " << numberOfInventedDevices[5].back() << endl;
+        cout << "TOOL: " << knownDevices[0] << ", ";
+        cout << "MACHINE: " << knownDevices[1] << ", ";
+        cout << "FACTORY: " << knownDevices[2] << ", ";
+        cout << "INDUSTRY: " << knownDevices[3] << ", ";
+        cout << "DEVMACHINE: " << knownDevices[4] << ", ";
+        cout << "DEVFACTORY: " << knownDevices[5] << endl;
     }
 }
 
@@ -801,30 +822,32 @@ void OtherStats::calcNumDevicesInvented()
  */
 void OtherStats::getSumResByAgent()
 {
-    int tempDayNum = 0;
-    int tempAgentId = 0;
-
-    // We have a "2D" vector vvi (vector of vector of int's) that we need to iterate through.  We
-    // need to set the iterator for each vector.
-    vector<int>::iterator dayIT;
-    vector<vector<int> >::iterator agentIT;
-
-    //	For every agent reset the day number equal to 0
-    for (agentIT = sumResByAgent.begin(); agentIT != sumResByAgent.end(); agentIT++) {
-        tempDayNum = 0;
-        //  For every day look up how many resources this agent owns
-        for (dayIT = (*agentIT).begin(); dayIT != (*agentIT).end(); dayIT++) {
-            if (DEBUG) {
-                cout << "Sum Res By Agent " << tempAgentId << ": "
-                     << sumResByAgent[tempAgentId][tempDayNum]
-                     << " on day #" << tempDayNum << endl;
-            }
-            tempDayNum++;
+    if (! DEBUG) {
+        return;
+    }
+    //	For every agent, for every day look up how many resources this agent owns
+    for (int aId = 0; aId < sumResByAgent.numRows(); aId++) {
+        DailyHistory<int>::Series held = sumResByAgent.series(aId);
+        for (int dayNum = 0; dayNum < held.size(); dayNum++) {
+            cout << "Sum Res By Agent " << aId << ": " << held[dayNum]
+                 << " on day #" << dayNum << endl;
         }
-        tempAgentId++;
     }
 }
 
+/**
+ * Keep the values of a long_output row that has been written, the row of
+ * the day after those kept so far (see outputRows).
+ * \param values the values of the row, in the order of its columns
+ */
+void OtherStats::addOutputRow(const vector<double> &values)
+{
+    if (outputRows.numRows() == 0) {
+        outputRows = DailyHistory<double>(1, values.size(), glob.NUM_DAYS);
+    }
+    appendDay(outputRows, values);
+}
+
 
 
 
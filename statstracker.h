@@ -25,6 +25,7 @@
 #include <vector>
 #include "globals.h"
 #include "marketplace.h"
+#include "history.h"
 using namespace std;
 
 class Device;
@@ -57,11 +58,11 @@ public:
     /**
      * \return the vector of sold number for each resource
      */
-    vector<int> getSoldExchanges() { return soldExchanges; }
+    const vector<int> & getSoldExchanges() const { return soldExchanges; }
     /**
      * \return the vector of bought number for each resource
      */
-    vector<int> getBoughtExchanges() { return boughtExchanges; }
+    const vector<int> & getBoughtExchanges() const { return boughtExchanges; }
     void addToSoldExchanges(int resId, int newVal) { soldExchanges[resId] += newVal; }      //!< update soldExchange
     void addToBoughtExchanges(int resId, int newVal) { boughtExchanges[resId] += newVal; }  //!< update boughtExchange
 };
@@ -72,166 +73,176 @@ class TradeStats
 {
 private:
     vector<int> 		 resTradeVolume;				        //!< indexed by day #
-    vector<vector<int> > resTradeVolumeByGroup;     //!< indexed by group # then day #
+    DailyHistory<int>    resTradeVolumeByGroup;     //!< indexed by day # then group #
     vector<int> 		 resTradeVolumeCrossGroup;           //!< index by day #
-    vector<vector<int> > resTradeVolumeWithinGroup; //!< indexed by group # then day #
+    DailyHistory<int>    resTradeVolumeWithinGroup; //!< indexed by day # then group #
 
     vector<int> 		 resTradeForDeviceVolume;		    //!< indexed by day #
-    vector<vector<int> > resTradeForDeviceVolumeByGroup;    //!< indexed by group # then day #
+    DailyHistory<int>    resTradeForDeviceVolumeByGroup;    //!< indexed by day # then group #
     vector<int> 		 resTradeForDeviceVolumeCrossGroup;          //!< indexed by day #
-    vector<vector<int> > resTradeForDeviceVolumeWithinGroup;//!< indexed by group # then day #
+    DailyHistory<int>    resTradeForDeviceVolumeWithinGroup;//!< indexed by day # then group #
 
     vector<DayExchangeStats> dayResExchanges;		//!< length NUM_RESOURCES
-    vector<vector<vector<vector<int> > > >resExchanges;/**< indexed by day first, then resId
-              then 0th is soldExchanges and 1st is boughtExchanges, both vectors of ints. */
+    /**
+     * Exchanges recorded by the worker threads during a parallel trade
+     * round; indexed by ThreadPool::threadIndex() (slot 0, the main thread,
+     * is not used) then resId.  Merged into dayResExchanges by
+     * mergeThreadExchanges().
+     */
+    vector<vector<DayExchangeStats> > threadResExchanges;
+    /**
+     * The soldExchanges (block 0) and boughtExchanges (block 1) of each
+     * day: indexed by the block, then day, then resId * NUM_RESOURCES + the
+     * resource it was exchanged for.
+     */
+    DailyHistory<int> resExchanges;
+
+    void calcTradeVolumes();
 
 public:
     TradeStats();
     void dailyUpdate();
     void newExchange(ResourcePair &pair);
+    void mergeThreadExchanges();
+    void saveState(ostream &out) const;
+    void loadState(istream &in);
 // BRH 11.11.2017 New vectors to save individual trades in memory
 	vector<int> tradeLog(); //!< laundry list of trade info
 
-    vector<int> 		 getResTradeVolume() { return resTradeVolume; };
-    vector<vector<int> > getResTradeVolumeByGroup() { return resTradeVolumeByGroup; };
-    vector<int> 		 getResTradeVolumeCrossGroup() { return resTradeVolumeCrossGroup; };
-    vector<vector<int> > getResTradeVolumeWithinGroup() { return resTradeVolumeWithinGroup; };
+    const vector<int> &		 getResTradeVolume() const { return resTradeVolume; };
+    const DailyHistory<int> &	 getResTradeVolumeByGroup() const { return resTradeVolumeByGroup; };
+    const vector<int> &		 getResTradeVolumeCrossGroup() const { return resTradeVolumeCrossGroup; };
+    const DailyHistory<int> &	 getResTradeVolumeWithinGroup() const { return resTradeVolumeWithinGroup; };
 
-    vector<int> 		 getResTradeForDeviceVolume() { return resTradeForDeviceVolume; };
-    vector<vector<int> > getResTradeForDeviceVolumeByGroup() { return resTradeForDeviceVolumeByGroup; };
-    vector<int> 		 getResTradeForDeviceVolumeCrossGroup() { return resTradeForDeviceVolumeCrossGroup; };
-    vector<vector<int> > getResTradeForDeviceVolumeWithinGroup() { return resTradeForDeviceVolumeWithinGroup; };
+    const vector<int> &		 getResTradeForDeviceVolume() const { return resTradeForDeviceVolume; };
+    const DailyHistory<int> &	 getResTradeForDeviceVolumeByGroup() const { return resTradeForDeviceVolumeByGroup; };
+    const vector<int> &		 getResTradeForDeviceVolumeCrossGroup() const { return resTradeForDeviceVolumeCrossGroup; };
+    const DailyHistory<int> &	 getResTradeForDeviceVolumeWithinGroup() const { return resTradeForDeviceVolumeWithinGroup; };
 };
 
 
 
 /**
  * ProductionStats
+ * Only the histories of the stats profile (see stats_profile_t) are
+ * recorded; the others stay empty.
  */
 class ProductionStats
 {
-    vector<int> 		 resGathered;			                /**< indexed by day # */
-    vector<vector<int> > resGatheredByAgent; 	        /**< indexed by agentId, then day */
-    vector<vector<int> > resGatheredByGroup;            /**< indexed by groupId, then day */
-
-    vector<vector<int> > 	numAgentsGatheringByRes;       /**< indexed by resId, then day */
-    vector<vector<int> > 		  resGatheredByRes;              /**< indexed by resId, then day */
-    vector<vector<vector<int> > > resGatheredByResByAgent; /**< indexed by resId, then agentId, then day */
-    vector<vector<int> > 		  resGatheredByDevice;          /**< indexed by device_name_t (first 4), then day */
-    vector<vector<vector<int> > > resGatheredByDeviceByRes; /**< indexed by device_name_t (first 4), then resId, then day. */
-
-    vector<vector<int> > 		  devicesMade;		            /**< indexed by device_name_t, then day */
-    vector<vector<vector<int> > > devicesMadeByRes;   /**< indexed by device_name_t, then resId, then day */
-    vector<vector<vector<int> > > devicesMadeByGroup; /**< indexed by agent type, then device_name_t, then day */
+    DailyHistory<int> 		 resGathered;			                /**< indexed by day # */
+    DailyHistory<int> resGatheredByAgent; 	        /**< indexed by day, then agentId */
+    DailyHistory<int> resGatheredByGroup;            /**< indexed by day, then groupId */
+
+    DailyHistory<int> 	numAgentsGatheringByRes;       /**< indexed by day, then resId */
+    DailyHistory<int> 		  resGatheredByRes;              /**< indexed by day, then resId */
+    DailyHistory<int> 			  resGatheredByResByAgent; /**< indexed by resId (the block), then day, then agentId */
+    DailyHistory<int> 		  resGatheredByDevice;          /**< indexed by day, then device_name_t (first 4) */
+    DailyHistory<int> resGatheredByDeviceByRes; /**< indexed by device_name_t (first 4, the block), then day, then resId. */
+
+    DailyHistory<int> 		  devicesMade;		            /**< indexed by day, then device_name_t */
+    DailyHistory<int> devicesMadeByRes;   /**< indexed by device_name_t (the block), then day, then resId */
+    DailyHistory<int> devicesMadeByGroup; /**< indexed by agent type (the block), then day, then device_name_t */
     /**
      * Number of devDevices made for this resource.
-     * indexed by device_name_t (only for DEVMACHINE and DEVFACTORY), and then day
+     * indexed by day, and then device_name_t (only for DEVMACHINE and DEVFACTORY)
      */
-    vector<vector<int> > 		  devicesMadeWithDevDevice;
+    DailyHistory<int> 		  devicesMadeWithDevDevice;
     /**
      * only for DEVMACHINE and DEVFACTORY
-     * indexed by device_name_t, then resId, then day
+     * indexed by device_name_t (the block), then day, then resId
      */
-    vector<vector<vector<int> > > devicesMadeWithDevDeviceByRes;
+    DailyHistory<int> devicesMadeWithDevDeviceByRes;
     /*
-     * Index by agent type, then by device_name_t, then day.
+     * Index by agent type (the block), then day, then by device_name_t.
      */
-    vector<vector<vector<int> > > devicesMadeWithDevDeviceByGroup;
+    DailyHistory<int> devicesMadeWithDevDeviceByGroup;
 
     /**
      * Each double is the total time spent by society without a device.
      * indexed by day
      */
     vector<double> 			timeSpentGatheringWithoutDevice;
-    vector<vector<double> > timeSpentGatheringWithoutDeviceByAgent;   /**< indexed by agentId, then day */
-    vector<vector<double> > timeSpentGatheringWithoutDeviceByGroup;  /**< indexed by groupId, then day */
-    vector<vector<double> > timeSpentGatheringWithoutDeviceByRes;        //[resId][day]
+    DailyHistory<double> 	timeSpentGatheringWithoutDeviceByAgent;   /**< indexed by day, then agentId */
+    DailyHistory<double> timeSpentGatheringWithoutDeviceByGroup;  /**< indexed by day, then groupId */
+    DailyHistory<double> timeSpentGatheringWithoutDeviceByRes;        //[day][resId]
     /**
      * Total time this agent spent gathering with a device.
-     * indexed by device_name_t (first 4), then agentId, then day.
+     * indexed by device_name_t (the block), then day, then agentId.
      */
-    vector<vector<double> > 		 timeSpentGatheringWithDevice;             /**< indexed by device_name_t (first 4), then day */
-    vector<vector<vector<double> > > timeSpentGatheringWithDeviceByAgent;
-    vector<vector<vector<double> > > timeSpentGatheringWithDeviceByGroup;         // *** indexed by device_name_t, then group id, then day
-    vector<vector<vector<double> > > timeSpentGatheringWithDeviceByRes; //[type][resId][day]
+    DailyHistory<double> 		 timeSpentGatheringWithDevice;             /**< indexed by day, then device_name_t */
+    DailyHistory<double> 			 timeSpentGatheringWithDeviceByAgent;
+    DailyHistory<double> timeSpentGatheringWithDeviceByGroup;         // *** indexed by group id (the block), then day, then device_name_t
+    DailyHistory<double> timeSpentGatheringWithDeviceByRes; //[type][day][resId]
 
 
     /**
      * Time the society spent gathering devices each day.
-     * indexed by device_name_t, then day
+     * indexed by day, then device_name_t
      */
     //JYC: added - 07.24.2018
-    vector<vector<double> > 		 timeSpentMakingDevices;
-    vector<vector<vector<double> > > timeSpentMakingDevicesByDeviceByRes;
+    DailyHistory<double> 		 timeSpentMakingDevices;
+    DailyHistory<double> timeSpentMakingDevicesByDeviceByRes;   //[type][day][resId]
      /**
       * Time this agent spent gathering this device.
-      * indexed by device_name_t, then agentId, then day.
+      * indexed by device_name_t (the block), then day, then agentId.
       */
-    vector<vector<vector<double> > > timeSpentMakingDevicesByAgent;
-    vector<vector<vector<double> > > timeSpentMakingDevicesByGroup;      // *** indexed by device_name_t, then group id, then day
+    DailyHistory<double> 			 timeSpentMakingDevicesByAgent;
+    DailyHistory<double> timeSpentMakingDevicesByGroup;      // *** indexed by group id (the block), then day, then device_name_t
 
 
     /**
      * Resources gathered with device / all resources gathered
-     * indexed by device_name_t (first 4), then day.
+     * indexed by day, then device_name_t (first 4).
      */
-    vector<vector<double> > 		 percentResGatheredByDevice;
+    DailyHistory<double> 		 percentResGatheredByDevice;
      /**
       * Amount of resources gathered with this / all of this specific resource gathered
-      * indexed by device_name_t (first 4), then resId, then day.
+      * indexed by device_name_t (first 4, the block), then day, then resId.
       */
-    vector<vector<vector<double> > > percentResGatheredByDeviceByRes;
-
-
-    void calcResGatheredAndResGatheredByAgentByGroup();
-    void calcResGatheredByResByAgentAndNumAgentsGetheringByRes();
-    void calcResGatheredByDevice();
-    void calcResGatheredByDeviceByRes();
-    void calcDevicesMade();
-    void calcDevicesMadeByRes();
-    void calcDevicesMadeWithDevDevicesByRes();
-    void calcTimeSpentGatheringWithoutDevice();
-    void calcTimeSpentGatheringWithDeviceAndTimeSpentMakingDevicesByAgent();
-    //JYC: method above includes calculation by res
+    DailyHistory<double> percentResGatheredByDeviceByRes;
+
+
     void calcPercentResGatheredByDevice();
     void calcPercentResGatheredByDeviceByRes();
 
 public:
     ProductionStats();
     void dailyUpdate ();
+    void saveState(ostream &out) const;
+    void loadState(istream &in);
 
-    vector<int> 				  getResGathered() { return resGathered; };
-    vector<vector<vector<int> > > getResGatheredByResByAgent() { return resGatheredByResByAgent; };
-    vector<vector<int> > 		  getResGatheredByRes() { return resGatheredByRes; };
-    vector<vector<int> > 		  getResGatheredByGroup() { return resGatheredByGroup; };
+    const DailyHistory<int> &		  getResGathered() const { return resGathered; };
+    const DailyHistory<int> &		  getResGatheredByResByAgent() const { return resGatheredByResByAgent; };
+    const DailyHistory<int> &		  getResGatheredByRes() const { return resGatheredByRes; };
+    const DailyHistory<int> &		  getResGatheredByGroup() const { return resGatheredByGroup; };
 
 
-    vector<vector<int> > 		  getDevicesMade() { return devicesMade; };
+    const DailyHistory<int> &	  getDevicesMade() const { return devicesMade; };
 /*BRH 10.11.2017 */
-	vector<vector<vector<int> > > getDevicesMadeByRes() { return devicesMadeByRes; };
-    vector<vector<vector<int> > > getDevicesMadeByGroup() { return devicesMadeByGroup; };
+	const DailyHistory<int> & getDevicesMadeByRes() const { return devicesMadeByRes; };
+    const DailyHistory<int> & getDevicesMadeByGroup() const { return devicesMadeByGroup; };
 
 
-    vector<vector<double> > 		 getTimeSpentGatheringWithDevice() { return timeSpentGatheringWithDevice; };
+    const DailyHistory<double> &		 getTimeSpentGatheringWithDevice() const { return timeSpentGatheringWithDevice; };
 /*BRH 07.17.2018 */
-    vector<vector<vector<double> > > getTimeSpentGatheringWithDeviceByRes() { return timeSpentGatheringWithDeviceByRes; };
-    vector<vector<vector<double> > > getTimeSpentGatheringWithDeviceByGroup() { return timeSpentGatheringWithDeviceByGroup; };
+    const DailyHistory<double> & getTimeSpentGatheringWithDeviceByRes() const { return timeSpentGatheringWithDeviceByRes; };
+    const DailyHistory<double> & getTimeSpentGatheringWithDeviceByGroup() const { return timeSpentGatheringWithDeviceByGroup; };
 
 
-    vector<double> 			getTimeSpentGatheringWithoutDevice() { return timeSpentGatheringWithoutDevice; };
-    vector<vector<double> > getTimeSpentGatheringWithoutDeviceByRes() { return timeSpentGatheringWithoutDeviceByRes; };
-    vector<vector<double> > getTimeSpentGatheringWithoutDeviceByGroup() { return timeSpentGatheringWithoutDeviceByGroup; };
+    const vector<double> &			getTimeSpentGatheringWithoutDevice() const { return timeSpentGatheringWithoutDevice; };
+    const DailyHistory<double> & getTimeSpentGatheringWithoutDeviceByRes() const { return timeSpentGatheringWithoutDeviceByRes; };
+    const DailyHistory<double> & getTimeSpentGatheringWithoutDeviceByGroup() const { return timeSpentGatheringWithoutDeviceByGroup; };
 
 
-    vector<vector<double> > 		 getTimeSpentMakingDevices() { return timeSpentMakingDevices; };
+    const DailyHistory<double> &		 getTimeSpentMakingDevices() const { return timeSpentMakingDevices; };
 //JYC: added - 07.24.2018
-    vector<vector<vector<double> > > getTimeSpentMakingDevicesByDeviceByRes() { return timeSpentMakingDevicesByDeviceByRes; }
-    vector<vector<vector<double> > > getTimeSpentMakingDevicesByGroup() { return timeSpentMakingDevicesByGroup; };
+    const DailyHistory<double> & getTimeSpentMakingDevicesByDeviceByRes() const { return timeSpentMakingDevicesByDeviceByRes; }
+    const DailyHistory<double> & getTimeSpentMakingDevicesByGroup() const { return timeSpentMakingDevicesByGroup; };
 
 
-    vector<vector<double> > 	  getPercentResGatheredByDevice() { return percentResGatheredByDevice; };
-    vector<vector<int> > 		  getDevicesMadeWithDevDevice() { return devicesMadeWithDevDevice; };
-    vector<vector<vector<int> > > getDevicesMadeWithDevDeviceByGroup() { return devicesMadeWithDevDeviceByGroup; };
+    const DailyHistory<double> & getPercentResGatheredByDevice() const { return percentResGatheredByDevice; };
+    const DailyHistory<int> &		  getDevicesMadeWithDevDevice() const { return devicesMadeWithDevDevice; };
+    const DailyHistory<int> & getDevicesMadeWithDevDeviceByGroup() const { return devicesMadeWithDevDeviceByGroup; };
     static const bool DEBUG_PRODUCTIONSTATS = false;
 };
 
@@ -240,52 +251,61 @@ class OtherStats
 {
     /**
      * The number of agents that are active on a given day.
-     * vector is indexed by day.
+     * Indexed by day.
      */
-    vector<int> activeAgents;
+    DailyHistory<int> activeAgents;
 
     /**
      * The number of agents in each group that are active on a given day.
-     * First indexed by group number, then by day.
+     * First indexed by day, then by group number.
      */
-    vector<vector<int> > activeGroupAgents;
+    DailyHistory<int> activeGroupAgents;
     /**
      * The sum of the resources held (I think) by all agents for each day.
-     * Vector is indexed by day.
+     * Indexed by day.
      */
-    vector<int> sumRes;
+    DailyHistory<int> sumRes;
     /**
      * The sum of the resources held by each agent, for each day.
-     * Vectors are indexed by agentId and day.
+     * Indexed by day and then agentId.
      */
-    vector<vector<int> > sumResByAgent;
+    DailyHistory<int> sumResByAgent;
     /**
      * The sum of the resources held by each group / type, for each day.
-     * Vectors are indexed by groupId and day.
+     * Indexed by day and groupId.
      */
-    vector<vector<int> > sumResByGroup;
+    DailyHistory<int> sumResByGroup;
 
     /**
      * The sum of the utilityToday values for agents, for each day.
-     * Vector is indexed by day.
+     * Indexed by day.
      */
-    vector<double> sumUtil;
+    DailyHistory<double> sumUtil;
     /**
      * The utilityToday values for each agent, for each day.
-     * Indexed by agentId and then day.
+     * Indexed by day and then agentId.
      */
-    vector<vector<double> > sumUtilByAgent;
+    DailyHistory<double> sumUtilByAgent;
     /**
      * The utilityToday values for each group / type, for each day.
-     * Indexed by groupId and then day.
+     * Indexed by day and then groupId.
+     */
+    DailyHistory<double> sumUtilByGroup;
+
+    /**
+     * The number of each type of device that is known, for each day.
+     * Indexed by day and then device type.
      */
-    vector<vector<double> > sumUtilByGroup;
+    DailyHistory<int> numberOfInventedDevices;
 
     /**
-     * Outer vector: Each type of device
-     * Inner vector: The number of this type of device that is known
+     * The values of the long_output rows written so far (see
+     * Utils::streamOutput()), indexed by day and then column.  They are
+     * only kept by a run that saves a day status or starts branches, whose
+     * long_output starts with these rows, since the stats they were
+     * calculated from are not all kept for so long (see stats_profile_t).
      */
-    vector<vector<int> > numberOfInventedDevices;
+    DailyHistory<double> outputRows;
 
     void calcSumResourcesByAgentByGroup();
     void calcSumUtility();
@@ -294,16 +314,20 @@ class OtherStats
 public:
     OtherStats();
     void dailyUpdate();
-    int getSumResBack()  { return sumRes.back(); };
-    int getSumUtilBack() { return sumUtil.back(); };
-    vector<double> 			getSumUtil() { return sumUtil; };
-    vector<vector<double> > getSumUtilByAgent() { return sumUtilByAgent; };
-    vector<vector<double> > getSumUtilByGroup() { return sumUtilByGroup; };
-    vector<int> 			getActiveAgents() { return activeAgents; };
-    vector< vector<int> > 	getActiveGroupAgents() { return activeGroupAgents; };
-    vector<int> 			getSumRes() { return sumRes; };
-    vector<vector<int> > 	getSumResByGroup() { return sumResByGroup; };
-    vector<vector<int> > 	getNumberOfInventedDevices() { return numberOfInventedDevices; };
+    void saveState(ostream &out) const;
+    void loadState(istream &in);
+    int getSumResBack() const  { return sumRes.at(sumRes.numDays() - 1); };
+    int getSumUtilBack() const { return sumUtil.at(sumUtil.numDays() - 1); };
+    const DailyHistory<double> &	getSumUtil() const { return sumUtil; };
+    const DailyHistory<double> &	getSumUtilByAgent() const { return sumUtilByAgent; };
+    const DailyHistory<double> &	getSumUtilByGroup() const { return sumUtilByGroup; };
+    const DailyHistory<int> &		getActiveAgents() const { return activeAgents; };
+    const DailyHistory<int> &		getActiveGroupAgents() const { return activeGroupAgents; };
+    const DailyHistory<int> &		getSumRes() const { return sumRes; };
+    const DailyHistory<int> &		getSumResByGroup() const { return sumResByGroup; };
+    const DailyHistory<int> &		getNumberOfInventedDevices() const { return numberOfInventedDevices; };
+    const DailyHistory<double> &	getOutputRows() const { return outputRows; };
+    void addOutputRow(const vector<double> &values);
     void getSumResByAgent();
     static const bool DEBUG = false;
     static const bool DEBUG_OTHERSTATS = false;
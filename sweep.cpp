@@ -0,0 +1,225 @@
+/**
+ * Parameter sweeps: the points of a sweep spec and the config files that
+ * make them (see sweep.h for the format of the spec).
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+#include "sweep.h"
+#include "options.h"
+#include "ran.h"
+
+/**
+ * Constructor.
+ */
+Sweep::Sweep()
+{
+    design = "grid";
+    samples = 0;
+}
+
+/**
+ * Split a "name = value ..." line of a spec or config file.
+ * \param line the line, without its comment
+ * \param name set to the trimmed text before the '='
+ * \param rest set to the trimmed text after the '='
+ * \return false if there is no '='.
+ */
+static bool splitSetting(string line, string &name, string &rest)
+{
+    size_t eq = line.find('=');
+    if (eq == string::npos) {
+        return false;
+    }
+    name = boost::algorithm::trim_copy(line.substr(0, eq));
+    rest = boost::algorithm::trim_copy(line.substr(eq + 1));
+    return true;
+}
+
+/**
+ * Read a sweep spec and make its points.
+ * \param filename the spec file
+ * \param seed the seed of the draws of an lhs design
+ * \return false (after telling why on cerr) if the spec cannot be used.
+ */
+bool Sweep::load(string filename, uint64_t seed)
+{
+    ifstream in(filename.c_str());
+    if (! in) {
+        cerr << "Could not open the sweep spec " << filename << endl;
+        return false;
+    }
+    string line;
+    int lineNum = 0;
+    while (getline(in, line)) {
+        lineNum++;
+        line = line.substr(0, line.find('#'));
+        if (boost::algorithm::trim_copy(line).empty()) {
+            continue;
+        }
+        string name, rest;
+        if (! splitSetting(line, name, rest)) {
+            cerr << filename << ":" << lineNum << ": expected name = value" << endl;
+            return false;
+        }
+        if (name == "design") {
+            design = rest;
+        } else if (name == "samples") {
+            try {
+                samples = boost::lexical_cast<int>(rest);
+            } catch (boost::bad_lexical_cast &) {
+                samples = 0;
+            }
+        } else if (isConfigFileOption(name)) {
+            istringstream words(rest);
+            vector<string> keyValues;
+            string word;
+            while (words >> word) {
+                keyValues.push_back(word);
+            }
+            if (keyValues.empty()) {
+                cerr << filename << ":" << lineNum << ": no values for " << name << endl;
+                return false;
+            }
+            keys.push_back(name);
+            values.push_back(keyValues);
+        } else {
+            cerr << filename << ":" << lineNum << ": " << name << " is not a config file option" << endl;
+            return false;
+        }
+    }
+    if (keys.empty()) {
+        cerr << filename << " does not sweep any option" << endl;
+        return false;
+    }
+
+    if (design == "grid") {
+        makeGrid();
+    } else if (design == "lhs") {
+        if (samples < 1) {
+            cerr << filename << ": an lhs design needs samples = (at least 1)" << endl;
+            return false;
+        }
+        for (unsigned k = 0; k < keys.size(); k++) {
+            if (values[k].size() != 2) {
+                cerr << filename << ": an lhs design needs a lower and an upper bound for " << keys[k] << endl;
+                return false;
+            }
+            try {
+                boost::lexical_cast<double>(values[k][0]);
+                boost::lexical_cast<double>(values[k][1]);
+            } catch (boost::bad_lexical_cast &) {
+                cerr << filename << ": the bounds of " << keys[k] << " are not numbers" << endl;
+                return false;
+            }
+        }
+        makeLatinHypercube(seed);
+    } else {
+        cerr << filename << ": unknown design " << design << " (should be grid or lhs)" << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Make a point for every combination of the values of the keys; the last
+ * key varies fastest.
+ */
+void Sweep::makeGrid()
+{
+    points.clear();
+    vector<unsigned> idx(keys.size(), 0);
+    while (true) {
+        vector<string> point;
+        for (unsigned k = 0; k < keys.size(); k++) {
+            point.push_back(values[k][idx[k]]);
+        }
+        points.push_back(point);
+
+        int k = keys.size() - 1;
+        while (k >= 0 && ++idx[k] == values[k].size()) {
+            idx[k] = 0;
+            k--;
+        }
+        if (k < 0) {
+            return;
+        }
+    }
+}
+
+/**
+ * Make samples points, each key taking its value from a different one of
+ * samples equal slices of its range at each point.
+ */
+void Sweep::makeLatinHypercube(uint64_t seed)
+{
+    Ran01<double> ran(seed);
+    points.assign(samples, vector<string>(keys.size()));
+    for (unsigned k = 0; k < keys.size(); k++) {
+        bool integral = (values[k][0].find_first_of(".eE") == string::npos &&
+                         values[k][1].find_first_of(".eE") == string::npos);
+        double lower = boost::lexical_cast<double>(values[k][0]);
+        double upper = boost::lexical_cast<double>(values[k][1]);
+        if (integral) {
+            upper += 1.0;   // the last slice ends just past upper
+        }
+
+        // slice[i] is the slice of the range that point i is drawn from
+        vector<int> slice;
+        for (int i = 0; i < samples; i++) {
+            slice.push_back(i);
+        }
+        for (int i = samples - 1; i > 0; i--) {
+            swap(slice[i], slice[(int) (ran() * (i + 1))]);
+        }
+        for (int i = 0; i < samples; i++) {
+            double value = lower + (slice[i] + ran()) / samples * (upper - lower);
+            if (integral) {
+                points[i][k] = boost::lexical_cast<string>(min((int) floor(value), (int) upper - 1));
+            } else {
+                points[i][k] = boost::lexical_cast<string>(value);
+            }
+        }
+    }
+}
+
+/**
+ * Write the config file of a point: the base config file with the swept
+ * options set to their values at the point.
+ * \param point the index of the point
+ * \param baseConfig the config file the sweep starts from
+ * \param path the config file to write
+ * \return false (after telling why on cerr) if a file cannot be read or written.
+ */
+bool Sweep::writePointConfig(int point, string baseConfig, string path) const
+{
+    ifstream in(baseConfig.c_str());
+    if (! in) {
+        cerr << "Could not open the config file " << baseConfig << endl;
+        return false;
+    }
+    ofstream out(path.c_str());
+    string line;
+    while (getline(in, line)) {
+        string name, rest;
+        if (splitSetting(line.substr(0, line.find('#')), name, rest) &&
+            find(keys.begin(), keys.end(), name) != keys.end()) {
+            continue;
+        }
+        out << line << "\n";
+    }
+    out << "\n# swept\n";
+    for (unsigned k = 0; k < keys.size(); k++) {
+        out << keys[k] << " = " << points[point][k] << "\n";
+    }
+    out.close();
+    if (! out) {
+        cerr << "Could not write the config file " << path << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+/**
+ * The sweep module includes the definition of the Sweep class, which reads
+ * a sweep spec (see --sweep) and lists the points of the parameter sweep.
+ *
+ * A sweep spec is a text file with one setting per line; # starts a comment.
+ *     design = grid           grid (the default) or lhs (Latin hypercube)
+ *     samples = 20            the number of points of an lhs design
+ *     MENU_SIZE = 1 3 5       grid: the values of a config file option
+ *     TRADE_EPSILON = .05 .3  lhs: the lower and upper bound of an option
+ * A grid sweep has a point for every combination of the values.  An lhs
+ * sweep draws samples points so that each of the samples equal slices of
+ * every range holds exactly one point; when both bounds are integers the
+ * option is drawn as an integer in [lower, upper].
+ */
+
+#ifndef _SOC_SWEEP_H_
+#define _SOC_SWEEP_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+class Sweep
+{
+private:
+    string design;
+    int samples;
+    vector<string> keys;               //!< the swept config file options
+    vector<vector<string> > values;    //!< grid: the values of each key; lhs: its bounds
+    vector<vector<string> > points;    //!< the value of each key at each point
+
+    void makeGrid();
+    void makeLatinHypercube(uint64_t seed);
+
+public:
+    Sweep();
+    bool load(string filename, uint64_t seed);
+    int numPoints() const { return (int) points.size(); }
+    const vector<string> &getKeys() const { return keys; }
+    const vector<string> &getPoint(int point) const { return points[point]; }
+    bool writePointConfig(int point, string baseConfig, string path) const;
+};
+
+
+#endif
@@ -0,0 +1,135 @@
+/**
+ * A small fixed-size pool of worker threads.  The calling thread takes
+ * part in every batch, so a pool of n threads starts n - 1 workers, and a
+ * pool of one thread runs everything serially without any locking.
+ */
+#include "threadpool.h"
+
+boost::thread_specific_ptr<int> ThreadPool::workerIndex;
+
+/**
+ * Constructor.
+ * \param numThreads the total number of threads (including the caller) to run tasks on
+ */
+ThreadPool::ThreadPool(int numThreads)
+{
+    numTasks = 0;
+    nextTask = 0;
+    tasksLeft = 0;
+    batch = 0;
+    shuttingDown = false;
+    for (int i = 1; i < numThreads; i++) {
+        workers.push_back(new boost::thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+/**
+ * Wake up all workers, let them exit and wait for them.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        boost::mutex::scoped_lock lock(mtx);
+        shuttingDown = true;
+    }
+    workReady.notify_all();
+    for (int i = 0; i < (int) workers.size(); i++) {
+        workers[i]->join();
+        delete workers[i];
+    }
+}
+
+/**
+ * \return the index of the calling thread in the pool: 0 for the thread
+ * that posts the batches (and for any thread outside the pool), 1 to
+ * size() - 1 for the workers.  Used to give each thread its own copy of
+ * shared scratch data.
+ */
+int ThreadPool::threadIndex()
+{
+    int *index = workerIndex.get();
+    return (index == NULL) ? 0 : *index;
+}
+
+/**
+ * Run f(0), f(1), ..., f(n - 1) on the threads of the pool and return
+ * once all of them are done.  The tasks must not depend on the order in
+ * which they are run.
+ * \param n the number of tasks
+ * \param f the task, called with the task index
+ */
+void ThreadPool::parallelFor(int n, boost::function<void (int)> f)
+{
+    if (workers.empty() || n <= 1) {
+        for (int i = 0; i < n; i++) {
+            f(i);
+        }
+        return;
+    }
+    {
+        boost::mutex::scoped_lock lock(mtx);
+        task = f;
+        numTasks = n;
+        nextTask = 0;
+        tasksLeft = n;
+        batch++;
+    }
+    workReady.notify_all();
+
+    runTasks();
+
+    boost::mutex::scoped_lock lock(mtx);
+    while (tasksLeft > 0) {
+        workDone.wait(lock);
+    }
+    task.clear();
+}
+
+/**
+ * Keep taking tasks of the current batch until there are none left.
+ */
+void ThreadPool::runTasks()
+{
+    while (true) {
+        int i;
+        {
+            boost::mutex::scoped_lock lock(mtx);
+            if (nextTask >= numTasks) {
+                return;
+            }
+            i = nextTask++;
+        }
+        // task is only replaced once every task of the batch has finished
+        task(i);
+        {
+            boost::mutex::scoped_lock lock(mtx);
+            if (--tasksLeft == 0) {
+                workDone.notify_all();
+            }
+        }
+    }
+}
+
+/**
+ * What each worker thread does: sleep until a batch is posted, help
+ * running it, then go back to sleep.
+ * \param index the index of this worker, see threadIndex()
+ */
+void ThreadPool::workerLoop(int index)
+{
+    workerIndex.reset(new int(index));
+    unsigned long lastBatch = 0;
+    while (true) {
+        {
+            boost::mutex::scoped_lock lock(mtx);
+            while (! shuttingDown && batch == lastBatch) {
+                workReady.wait(lock);
+            }
+            if (shuttingDown) {
+                return;
+            }
+            lastBatch = batch;
+        }
+        runTasks();
+    }
+}
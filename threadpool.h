@@ -0,0 +1,48 @@
+/**
+ * The threadpool module includes the definition of the ThreadPool class,
+ * a fixed set of worker threads used to run the independent per-agent
+ * parts of a day (e.g. the work phase) in parallel.
+ */
+
+#ifndef _SOC_THREADPOOL_H_
+#define _SOC_THREADPOOL_H_
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/tss.hpp>
+
+using namespace std;
+
+class ThreadPool
+{
+private:
+    vector<boost::thread *> workers;
+    boost::mutex mtx;
+    boost::condition_variable workReady;    //!< signalled when a new batch is posted
+    boost::condition_variable workDone;     //!< signalled when the last task of a batch ends
+
+    boost::function<void (int)> task;       //!< the task of the current batch
+    int numTasks;           //!< number of tasks in the current batch
+    int nextTask;           //!< index of the next task to hand out
+    int tasksLeft;          //!< number of tasks not finished yet
+    unsigned long batch;    //!< incremented every time a batch is posted
+    bool shuttingDown;
+
+    static boost::thread_specific_ptr<int> workerIndex;    //!< set in each worker thread
+
+    void workerLoop(int index);
+    void runTasks();
+
+public:
+    ThreadPool(int numThreads);
+    ~ThreadPool();
+    int size() const { return (int) workers.size() + 1; }
+    static int threadIndex();
+    void parallelFor(int n, boost::function<void (int)> f);
+};
+
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * The tournament module includes the definition of the TournamentTree
+ * class, a complete binary tree over a vector of values in which every
+ * node holds the maximum of its two children.  Changing a value costs
+ * O(log n), the maximum is at the root, and the indexes of all the values
+ * at or above a threshold are listed without visiting the subtrees whose
+ * maximum is below it.
+ */
+
+#ifndef _SOC_TOURNAMENT_H_
+#define _SOC_TOURNAMENT_H_
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+class TournamentTree
+{
+private:
+    int leaves;                 //!< the number of leaves, a power of 2
+    vector<double> node;        //!< node[1] is the root; the leaves start at node[leaves]
+
+    void collect(int n, double threshold, vector<int> &indexes) const
+    {
+        if (node[n] < threshold) {
+            return;
+        }
+        if (n >= leaves) {
+            indexes.push_back(n - leaves);
+            return;
+        }
+        collect(2 * n, threshold, indexes);
+        collect(2 * n + 1, threshold, indexes);
+    }
+
+public:
+    /**
+     * Constructor.
+     * \param values the values of the leaves
+     */
+    TournamentTree(const vector<double> &values)
+    {
+        leaves = 1;
+        while (leaves < (int) values.size()) {
+            leaves *= 2;
+        }
+        node.assign(2 * leaves, -numeric_limits<double>::infinity());
+        for (unsigned i = 0; i < values.size(); i++) {
+            node[leaves + i] = values[i];
+        }
+        for (int n = leaves - 1; n >= 1; n--) {
+            node[n] = max(node[2 * n], node[2 * n + 1]);
+        }
+    }
+
+    double maxValue() const { return node[1]; }
+    double value(int index) const { return node[leaves + index]; }
+
+    /**
+     * Change the value of a leaf and the maxima above it.
+     */
+    void update(int index, double value)
+    {
+        int n = leaves + index;
+        node[n] = value;
+        for (n /= 2; n >= 1; n /= 2) {
+            double best = max(node[2 * n], node[2 * n + 1]);
+            if (node[n] == best) {
+                break;      // the maxima further up do not change either
+            }
+            node[n] = best;
+        }
+    }
+
+    /**
+     * Append to indexes, in increasing order, the indexes of the values at
+     * or above threshold.
+     */
+    void atLeast(double threshold, vector<int> &indexes) const
+    {
+        collect(1, threshold, indexes);
+    }
+};
+
+
+#endif
@@ -5,12 +5,17 @@
 #include <vector>
 #include <cstdio>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <cassert>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 #include <boost/foreach.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
@@ -22,7 +27,11 @@
 #include "marketplace.h"
 #include "statstracker.h"
 #include "devmarketplace.h"
+#include "threadpool.h"
+#include "binaryio.h"
+#include "columnfile.h"
 #include "logging.h"
+#include "statistics.h"
 
 using namespace std;
 
@@ -36,17 +45,26 @@ void Utils::printStartConditions()
     cout << "Number of resources: " << glob.NUM_RESOURCES << endl;
 }
 
+/**
+ * Used below for running the work day of one agent on the thread pool.
+ */
+static void agentWorkDay(int agentIndex)
+{
+    if (glob.agent[agentIndex]->inSimulation) {
+        glob.agent[agentIndex]->workDay();
+    }
+}
+
 /**
  * Let the agents start working.
+ * A work day only changes the agent's own properties and draws from the
+ * agent's own RandomStream, so the agents work in parallel on
+ * glob.threadPool and the results are the same for any number of threads.
  */
 void Utils::agentsWork()
 {
     LOG(2) << "Entering agents work phase";
-    BOOST_FOREACH(Agent *agent, glob.agent) {
-        if (agent->inSimulation) {
-            agent->workDay();
-        }
-    }
+    glob.threadPool->parallelFor(glob.agent.size(), agentWorkDay);
 }
 
 /**
@@ -228,6 +246,9 @@ void Utils::dayAnalysis(int dayNumber)
     glob.productionStats->dailyUpdate();
     glob.otherStats->dailyUpdate();
     glob.otherStats->getSumResByAgent();
+    if (glob.END_SAVE) {
+        streamOutput(dayNumber, false);
+    }
 
     BOOST_FOREACH(Agent *agent, glob.agent) {
         agent->resetTodayStats();
@@ -240,11 +261,6 @@ void Utils::dayAnalysis(int dayNumber)
 void Utils::removeOrSave(int dayNumber)
 {
     LOG(2) << "Entering remove or save phase";
-    if (glob.SAVE_DAY_STATUS) {
-        if (dayNumber == glob.DAY_FOR_SAVE) {
-            saveDayStatus(dayNumber);
-        }
-    }
     if (glob.REMOVE_RES) {
         if (dayNumber == glob.REMOVE_RES_DAY) {
             glob.removeRes(glob.RES_TO_REMOVE, dayNumber);
@@ -255,6 +271,12 @@ void Utils::removeOrSave(int dayNumber)
             glob.removeAgent(glob.AGENT_TO_REMOVE, dayNumber);
         }
     }
+    // saved last, so that a restarted run does not miss this day's removals
+    if (glob.SAVE_DAY_STATUS) {
+        if (dayNumber == glob.DAY_FOR_SAVE) {
+            saveDayStatus(dayNumber);
+        }
+    }
 }
 
 
@@ -289,95 +311,25 @@ void Utils::endSim()
     }
 }
 
-/**
- * Used to sort a vector of vectors. Only sort on the first item.
- */
-bool mySort(const vector<double>& i, const vector<double>& j)
-{
-    return i[0] < j[0];
-}
-
-
 /**
  * Compute the five quartiles of elements of each index position.
  * \param data a vector of a vector of double
  * \return five vectors of double with min, 25%, median, 75%, max.
  */
-vector<vector<double> > Utils::calcQuartiles(vector<vector<double> > data)
+vector<vector<double> > Utils::calcQuartiles(const vector<vector<double> > &data)
 {
-    vector<double> min;     // a vector of each index's minimum value of all sub-vectors in data
-    vector<double> med;     // a vector of each index's median value of all sub-vectors in data
-    vector<double> max;     // a vector of each index's maximum value of all sub-vectors in data
-    vector<vector<double> > copy = data;    // make a copy so the original data will not be changed
-
-    bool even;
-    if (copy.size() % 2 == 0) {
-        even = true;
-    } else {
-        even = false;
-    }
-
-    /*
-     * Find the min, median, and max.
-     */
-    for ( unsigned int m = 0; m < copy[0].size(); m++) {
-        if ( m != 0 ) {
-            for (unsigned int i = 0; i < copy.size(); i++) {
-                swap(copy[i][m], copy[i][0]);
-            }
+    vector<vector<double> > result(5);
+    vector<double> values;      // the values of one index position, reordered by quartiles()
+    for (unsigned int m = 0; m < data[0].size(); m++) {
+        values.clear();
+        for (unsigned int i = 0; i < data.size(); i++) {
+            values.push_back(data[i][m]);
         }
-        sort(copy.begin(), copy.end(), mySort);
-        min.push_back(copy[0][0]);
-        if (even) {
-            med.push_back( (copy[copy.size()/2-1][0] + copy[copy.size()/2][0]) / 2.0 );
-        } else {
-            med.push_back(copy[copy.size() / 2][0]);
+        vector<double> q = quartiles(values);
+        for (unsigned int j = 0; j < q.size(); j++) {
+            result[j].push_back(q[j]);
         }
-        max.push_back(copy[copy.size()-1][0]);
     }
-
-    /*
-     * Find the first and third quartile.
-     */
-    vector<double> qOne;
-    vector<double> qThree;
-    vector<double> aboveMedian;
-    vector<double> belowMedian;
-    for (int dayNum = 0; dayNum < glob.NUM_DAYS; dayNum++) {
-        aboveMedian.clear();
-        belowMedian.clear();
-        for (unsigned int vecId = 0; vecId < data.size(); vecId++) {
-            if (data[vecId][dayNum] >= med[dayNum]) {
-                aboveMedian.push_back(data[vecId][dayNum]);
-            }
-            if (data[vecId][dayNum] <= med[dayNum]) {
-                belowMedian.push_back(data[vecId][dayNum]);
-            }
-        }
-
-        sort(belowMedian.begin(), belowMedian.end());
-        if (belowMedian.size() % 2 == 0) {
-            qOne.push_back( (belowMedian[belowMedian.size()/2-1] + belowMedian[belowMedian.size()/2]) / 2.0 );
-        } else {
-            qOne.push_back( belowMedian[belowMedian.size() / 2] );
-        }
-        sort(aboveMedian.begin(), aboveMedian.end());
-        if (aboveMedian.size() % 2 == 0) {
-            qThree.push_back( (aboveMedian[aboveMedian.size()/2-1] + aboveMedian[aboveMedian.size()/2]) / 2.0 );
-        } else {
-            qThree.push_back( aboveMedian[aboveMedian.size() / 2] );
-        }
-    }
-
-    vector<vector<double> > result;
-    result.push_back(min);
-    result.push_back(qOne);
-    result.push_back(med);
-    result.push_back(qThree);
-    result.push_back(max);
-
-    copy.clear();
-
     return result;
 }
 
@@ -473,23 +425,31 @@ void Utils::saveUniqueKey()
 void Utils::firstRunCheck(ofstream &file, string filePath)
 {
     if ( !boost::filesystem::exists(filePath)) {
+        saveBatchInfo();
+    }
+}
+
+/**
+ * Save the UniqueKey and parameters of this batch of runs, and a copy of
+ * its config files in SAVE_FOLDER/configFiles.
+ */
+void Utils::saveBatchInfo()
+{
 //(1) 	Save the UniqueKey for this batch of runs and all of the parameters to a file	
-		saveUniqueKey();
+	saveUniqueKey();
 
 //(2) 	Save a copy of the config file and the agent config files.	
-		int command;
-		string conf = glob.SAVE_FOLDER + "/configFiles";
-		string commandLine;
-		if (glob.configAgentCSV != "") {
-			commandLine = "cp " + glob.configAgentFilename + " "
-					+ glob.configAgentCSV + " "
-					+ glob.configFilename + " " + conf;
-		} else {
-			commandLine = "cp " + glob.configAgentFilename + " " + glob.configFilename + " " + conf;
-		}
-		command = system(commandLine.c_str());
-
-    }
+	int command;
+	string conf = glob.SAVE_FOLDER + "/configFiles";
+	string commandLine;
+	if (glob.configAgentCSV != "") {
+		commandLine = "cp " + glob.configAgentFilename + " "
+				+ glob.configAgentCSV + " "
+				+ glob.configFilename + " " + conf;
+	} else {
+		commandLine = "cp " + glob.configAgentFilename + " " + glob.configFilename + " " + conf;
+	}
+	command = system(commandLine.c_str());
 }
 
 void Utils::headerByDay(ofstream &file, string filePath)
@@ -525,24 +485,17 @@ void Utils::saveGini()
      */
    file << "giniPerAgent_"<< glob.SIM_NAME << ",,";   // Leave the first day blank
     vector<double> orderedUtils;
-    vector<double> y;
-    vector<vector<double> > sumUtilByAgent = glob.otherStats->getSumUtilByAgent();
+    const DailyHistory<double> &sumUtilByAgent = glob.otherStats->getSumUtilByAgent();
     for (int dayNum = 1; dayNum < glob.NUM_DAYS-1; dayNum++) {//for every day...
         orderedUtils.clear();
         for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {//for every agent
             if (glob.agent[aId]->inSimulation) {
                 // takes a four-day average (one before, two after) of utility to calculate Gini coefficient
-                orderedUtils.push_back(accumulate(sumUtilByAgent[aId].begin() + dayNum - 1,
-                                                sumUtilByAgent[aId].begin() + dayNum + 2, 0.0));// create vector of utilities per agent
+                DailyHistory<double>::Series utils = sumUtilByAgent.series(aId);
+                orderedUtils.push_back(0.0 + utils[dayNum - 1] + utils[dayNum] + utils[dayNum + 1]);// create vector of utilities per agent
             }
         }
-        sort(orderedUtils.begin(), orderedUtils.end());//orders utilities smallest to largest
-        y.clear();
-        for (unsigned int i = 0; i < orderedUtils.size(); i++) {
-            y.push_back(accumulate(orderedUtils.begin(), orderedUtils.begin() + i + 1, 0));// seems to be sum of utilities up to a point, cumulative histogram type thing.
-        }
-        double B = accumulate(y.begin(), y.end(), 0.0) / (y[y.size()-1] * double(orderedUtils.size())); // arbitrary variable used in final calc.
-        file << (1.0 + (1.0 / double(orderedUtils.size())) - (2.0 * B)) << ",";// final calculation.
+        file << gini(orderedUtils) << ",";
     }
     file << ",\n";      // leave the last day blank
 
@@ -556,27 +509,17 @@ void Utils::saveGini()
             for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
                 if (glob.agent[aId]->group == gId) {
                     if (glob.agent[aId]->inSimulation) {
-                        orderedUtils.push_back(accumulate(sumUtilByAgent[aId].begin() + dayNum - 1,
-                                                        sumUtilByAgent[aId].begin() + dayNum + 2, 0.0));
+                        DailyHistory<double>::Series utils = sumUtilByAgent.series(aId);
+                        orderedUtils.push_back(0.0 + utils[dayNum - 1] + utils[dayNum] + utils[dayNum + 1]);
                     }
                 }
             }
-            sort(orderedUtils.begin(), orderedUtils.end());
-            y.clear();
-            for (unsigned int i = 0; i < orderedUtils.size(); i++) {
-                y.push_back(accumulate(orderedUtils.begin(), orderedUtils.begin() + i + 1, 0));
-            }
-            double B = accumulate(y.begin(), y.end(), 0.0) / (y[y.size()-1] * double(orderedUtils.size()));
-            file << (1.0 + (1.0 / double(orderedUtils.size())) - (2.0 * B)) << ",";
+            file << gini(orderedUtils) << ",";
         }
         file << ",\n";      // leave the last day blank
     }
     file << "\n";
     file.close();
-
-    orderedUtils.clear();
-    y.clear();
-    sumUtilByAgent.clear();
 }
 
 /**
@@ -591,8 +534,8 @@ void Utils::saveHHIQuartiles()
     file.open(filePath.c_str(), ios::app);
 
     string quartileNames[] = { "min", "q1", "median", "q3", "max" };
-    vector<vector<int> > resGatheredByRes = glob.productionStats->getResGatheredByRes();
-    vector<vector<vector<int> > > resGatheredByResByAgent = glob.productionStats->getResGatheredByResByAgent();
+    const DailyHistory<int> &resGatheredByRes = glob.productionStats->getResGatheredByRes();
+    const DailyHistory<int> &resGatheredByResByAgent = glob.productionStats->getResGatheredByResByAgent();
 
     /*
      * Save HHI for all agents
@@ -604,9 +547,10 @@ void Utils::saveHHIQuartiles()
         HHIpoints.clear();
         for (int dayNum = 0; dayNum < glob.NUM_DAYS; dayNum++) {
             HHI = 0;
-            if (resGatheredByRes[resId][dayNum] > 0) {
+            if (resGatheredByRes.dayRow(dayNum)[resId] > 0) {
+                const int *gatheredByAgent = resGatheredByResByAgent.dayRow(dayNum, resId);
                 for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
-                    HHI += pow((double(resGatheredByResByAgent[resId][aId][dayNum]) / double(resGatheredByRes[resId][dayNum])), 2);
+                    HHI += pow((double(gatheredByAgent[aId]) / double(resGatheredByRes.dayRow(dayNum)[resId])), 2);
                 }
             }
             HHIpoints.push_back(HHI);
@@ -632,10 +576,11 @@ void Utils::saveHHIQuartiles()
             HHIpoints.clear();
             for (int dayNum = 0; dayNum < glob.NUM_DAYS; dayNum++) {
                 HHI = 0;
-                if (resGatheredByRes[resId][dayNum] > 0) {
+                if (resGatheredByRes.dayRow(dayNum)[resId] > 0) {
+                    const int *gatheredByAgent = resGatheredByResByAgent.dayRow(dayNum, resId);
                     for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
                         if (glob.agent[aId]->group == gId) {
-                            HHI += pow((double(resGatheredByResByAgent[resId][aId][dayNum]) / double(resGatheredByRes[resId][dayNum])), 2);
+                            HHI += pow((double(gatheredByAgent[aId]) / double(resGatheredByRes.dayRow(dayNum)[resId])), 2);
                         }
                     }
                 }
@@ -660,8 +605,6 @@ void Utils::saveHHIQuartiles()
     file << "\n";
     file.close();
 
-    resGatheredByRes.clear();
-    resGatheredByResByAgent.clear();
     data.clear();
     HHIpoints.clear();
     dataGroup.clear();
@@ -679,13 +622,11 @@ void Utils::saveTotalUtility()
     file.open(filePath.c_str(), ios::app);
 
     file << "sumUtil,";
-    vector<double> sumUtil = glob.otherStats->getSumUtil();
+    const DailyHistory<double> &sumUtil = glob.otherStats->getSumUtil();
     for (int i = 0; i < glob.NUM_DAYS; i++) {
-        file << (sumUtil[i]) << ",";
+        file << (sumUtil.at(i)) << ",";
     }
     file.close();
-
-    sumUtil.clear();
 }
 
 /**
@@ -701,30 +642,25 @@ void Utils::saveMeanUtility()
 
     /* mean utility per agent */
     file << "meanUtilPerAgent,";
-    vector<double> sumUtil = glob.otherStats->getSumUtil();
-    vector<int> activeAgents = glob.otherStats->getActiveAgents();
+    const DailyHistory<double> &sumUtil = glob.otherStats->getSumUtil();
+    const DailyHistory<int> &activeAgents = glob.otherStats->getActiveAgents();
     for (int i = 0; i < glob.NUM_DAYS; i++) {
-        file << (sumUtil[i] / activeAgents[i]) << ",";
+        file << (sumUtil.at(i) / activeAgents.at(i)) << ",";
     }
     file << "\n";
 
     /* mean utility per group */
-    vector<vector<double> > sumUtilByGroup = glob.otherStats->getSumUtilByGroup();
-    vector<vector<int> > activeGroupAgents = glob.otherStats->getActiveGroupAgents();
+    const DailyHistory<double> &sumUtilByGroup = glob.otherStats->getSumUtilByGroup();
+    const DailyHistory<int> &activeGroupAgents = glob.otherStats->getActiveGroupAgents();
     for (int i = 0; i < glob.NUM_AGENT_GROUPS; i++) {
         file << "meanUtilByGroup_" << i << "_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double)sumUtilByGroup[i][j] / (double)activeGroupAgents[i][j]) << ",";
+            file << ( (double)sumUtilByGroup.dayRow(j)[i] / (double)activeGroupAgents.dayRow(j)[i]) << ",";
         }
         file << "\n";
     }
     file << "\n";
     file.close();
-
-    sumUtil.clear();
-    activeAgents.clear();
-    activeGroupAgents.clear();
-    sumUtilByGroup.clear();
 }
 
 /**
@@ -749,19 +685,17 @@ void Utils::saveUnitsGathered()
 	file.open(filePath.c_str(), ios::app);   /*open that particular file in append mode */
 
 
-    vector<vector<int> > resGatheredByRes = glob.productionStats->getResGatheredByRes();
+    const DailyHistory<int> &resGatheredByRes = glob.productionStats->getResGatheredByRes();
     
         file << glob.UniqueKey << ",";
 		file << glob.configName << "," ;
 		file << glob.SIM_NAME << "," ;
         file << glob.currentDay+1  ;
         for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-            file << "," << resGatheredByRes[resId][glob.currentDay];   
+            file << "," << resGatheredByRes.dayRow(glob.currentDay)[resId];   
         }
     file << "\n";
     file.close();
-
-    resGatheredByRes.clear();
 }
 
 /**
@@ -777,30 +711,25 @@ void Utils::saveUnitsHeld()
 
     /* unitsHeld per agent */
     file << "unitsHeldPerActiveAgent_" << glob.SIM_NAME << ",";
-    vector<int> sumRes = glob.otherStats->getSumRes();
-    vector<int> activeAgents = glob.otherStats->getActiveAgents();
+    const DailyHistory<int> &sumRes = glob.otherStats->getSumRes();
+    const DailyHistory<int> &activeAgents = glob.otherStats->getActiveAgents();
     for (int i = 0; i < glob.NUM_DAYS; i++) {
-        file << ( (double) sumRes[i] / (double) activeAgents[i] ) << ",";
+        file << ( (double) sumRes.at(i) / (double) activeAgents.at(i) ) << ",";
     }
     file << "\n";
 
     /* unitsHeld per group */
-    vector<vector<int> > resHeldByGroup = glob.otherStats->getSumResByGroup();
-    vector<vector<int> > activeGroupAgents = glob.otherStats->getActiveGroupAgents();
+    const DailyHistory<int> &resHeldByGroup = glob.otherStats->getSumResByGroup();
+    const DailyHistory<int> &activeGroupAgents = glob.otherStats->getActiveGroupAgents();
     for (int i = 0; i < glob.NUM_AGENT_GROUPS; i++) {
         file << "unitsHeldByGroup_" << i << "_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double)resHeldByGroup[i][j] / (double)activeGroupAgents[i][j]) << ",";
+            file << ( (double)resHeldByGroup.dayRow(j)[i] / (double)activeGroupAgents.dayRow(j)[i]) << ",";
         }
         file << "\n";
     }
     file << "\n";
     file.close();
-
-    sumRes.clear();
-    activeAgents.clear();
-    activeGroupAgents.clear(); 
-    resHeldByGroup.clear();
 }
 
 /**
@@ -815,92 +744,83 @@ void Utils::saveUnitsTraded()
     headerByDay(file, filePath);
     file.open(filePath.c_str(), ios::app);
 
-    vector<int> activeAgents = glob.otherStats->getActiveAgents();
+    const DailyHistory<int> &activeAgents = glob.otherStats->getActiveAgents();
 
     /* unitsTradedForDevice per agent */
-    vector<int> resTradeForDeviceVolume = glob.tradeStats->getResTradeForDeviceVolume();
+    const vector<int> &resTradeForDeviceVolume = glob.tradeStats->getResTradeForDeviceVolume();
     file << "unitsTradedForDevicePerActiveAgent_" << glob.SIM_NAME << ",";
     for (int i = 0; i < glob.NUM_DAYS; i++) {
-        file << ( (double) resTradeForDeviceVolume[i] / (double) activeAgents[i] ) << ",";
+        file << ( (double) resTradeForDeviceVolume[i] / (double) activeAgents.at(i) ) << ",";
     }
     file << "\n";
 
     /* unitsTradedForDevice per group */
-    vector<vector<int> > resTradedForDeviceVolumeByGroup = glob.tradeStats->getResTradeForDeviceVolumeByGroup();
-    vector<vector<int> > activeGroupAgents = glob.otherStats->getActiveGroupAgents();
+    const DailyHistory<int> &resTradedForDeviceVolumeByGroup = glob.tradeStats->getResTradeForDeviceVolumeByGroup();
+    const DailyHistory<int> &activeGroupAgents = glob.otherStats->getActiveGroupAgents();
     for (int i = 0; i < glob.NUM_AGENT_GROUPS; i++) {
         file << "unitsTradedForDeviceByGroup_" << i << "_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double)resTradedForDeviceVolumeByGroup[i][j] / (double)activeGroupAgents[i][j]) << ",";
+            file << ( (double)resTradedForDeviceVolumeByGroup.dayRow(j)[i] / (double)activeGroupAgents.dayRow(j)[i]) << ",";
         }
         file << "\n";
     }
 
     /* unitsTradedForDevice in total when trading agents are from different groups */
-    vector<int> resTradeForDeviceVolumeCrossGroup = glob.tradeStats->getResTradeForDeviceVolumeCrossGroup();
+    const vector<int> &resTradeForDeviceVolumeCrossGroup = glob.tradeStats->getResTradeForDeviceVolumeCrossGroup();
     file << "unitsTradedForDeviceCrossGroup_" << glob.SIM_NAME << ",";
     for (int i = 0; i < glob.NUM_DAYS; i++) {
-        file << ( (double) resTradeForDeviceVolumeCrossGroup[i] / (double) activeAgents[i] ) << ",";
+        file << ( (double) resTradeForDeviceVolumeCrossGroup[i] / (double) activeAgents.at(i) ) << ",";
     }
     file << "\n";
 
     /* unitsTradedForDevice when trading agents are from the same groups */
-    vector<vector<int> > resTradedForDeviceVolumeWithinGroup = glob.tradeStats->getResTradeForDeviceVolumeWithinGroup();
+    const DailyHistory<int> &resTradedForDeviceVolumeWithinGroup = glob.tradeStats->getResTradeForDeviceVolumeWithinGroup();
     for (int i = 0; i < glob.NUM_AGENT_GROUPS; i++) {
         file << "unitsTradedForDeviceWithinGroup " << i << "_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double)resTradedForDeviceVolumeWithinGroup[i][j] / (double)activeGroupAgents[i][j]) << ",";
+            file << ( (double)resTradedForDeviceVolumeWithinGroup.dayRow(j)[i] / (double)activeGroupAgents.dayRow(j)[i]) << ",";
         }
         file << "\n";
     }
 
     /* unitsTradedForRes per agent */
     file << "unitsTradedForResPerActiveAgent_" << glob.SIM_NAME << ",";
-    vector<int> resTradeVolume = glob.tradeStats->getResTradeVolume();
+    const vector<int> &resTradeVolume = glob.tradeStats->getResTradeVolume();
     for (int i = 0; i < glob.NUM_DAYS; i++) {
-        file << ( (double) resTradeVolume[i] / (double) activeAgents[i] ) << ",";
+        file << ( (double) resTradeVolume[i] / (double) activeAgents.at(i) ) << ",";
     }
     file << "\n";
 
     /* unitsTradedForRes per group */
-    vector<vector<int> > resTradeVolumeByGroup = glob.tradeStats->getResTradeVolumeByGroup();
+    const DailyHistory<int> &resTradeVolumeByGroup = glob.tradeStats->getResTradeVolumeByGroup();
     for (int i = 0; i < glob.NUM_AGENT_GROUPS; i++) {
         file << "unitsTradedForResByGroup_" << i << "_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double)resTradeVolumeByGroup[i][j] / (double)activeGroupAgents[i][j]) << ",";
+            file << ( (double)resTradeVolumeByGroup.dayRow(j)[i] / (double)activeGroupAgents.dayRow(j)[i]) << ",";
         }
         file << "\n";
     }
 
     /* unitsTradedForRes when trading agents are from different groups */
     file << "unitsTradedForResCrossGroup_" << glob.SIM_NAME << ",";
-    vector<int> resTradeVolumeCrossGroup = glob.tradeStats->getResTradeVolumeCrossGroup();
+    const vector<int> &resTradeVolumeCrossGroup = glob.tradeStats->getResTradeVolumeCrossGroup();
     for (int i = 0; i < glob.NUM_DAYS; i++) {
-        file << ( (double) resTradeVolumeCrossGroup[i] / (double) activeAgents[i] ) << ",";
+        file << ( (double) resTradeVolumeCrossGroup[i] / (double) activeAgents.at(i) ) << ",";
     }
     file << "\n";
 
     /* unitsTradedForRes when trading agents are from the same group */
-    vector<vector<int> > resTradeVolumeWithinGroup = glob.tradeStats->getResTradeVolumeWithinGroup();
+    const DailyHistory<int> &resTradeVolumeWithinGroup = glob.tradeStats->getResTradeVolumeWithinGroup();
     for (int i = 0; i < glob.NUM_AGENT_GROUPS; i++) {
         file << "unitsTradedForResWithinGroup " << i << "_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double)resTradeVolumeWithinGroup[i][j] / (double)activeGroupAgents[i][j]) << ",";
+            file << ( (double)resTradeVolumeWithinGroup.dayRow(j)[i] / (double)activeGroupAgents.dayRow(j)[i]) << ",";
         }
         file << "\n";
     }
 
     file << "\n";
     file.close();
-
-    activeAgents.clear();
-    activeGroupAgents.clear(); 
-    resTradeForDeviceVolume.clear();
-    resTradedForDeviceVolumeByGroup.clear();
-    resTradeForDeviceVolumeCrossGroup.clear();
-    resTradeVolume.clear();
-    resTradeVolumeByGroup.clear();
-    resTradeVolumeCrossGroup.clear();
 }
 
 /**
@@ -914,38 +834,33 @@ void Utils::saveDeviceMade()
     headerByDay(file, filePath);
     file.open(filePath.c_str(), ios::app);
 
-    vector<int> activeAgents = glob.otherStats->getActiveAgents();
+    const DailyHistory<int> &activeAgents = glob.otherStats->getActiveAgents();
     string devicesStr[] = { "TOOL", "MACHINE", "FACTORY", "INDUSTRY", "DEVMACHINE", "DEVFACTORY" };
 
     /* device made per agent */
-    vector< vector<int> > devicesMade = glob.productionStats->getDevicesMade();
+    const DailyHistory<int> &devicesMade = glob.productionStats->getDevicesMade();
     for (int i = 0; i < NUM_DEVICE_TYPES; i++) {
         file << devicesStr[i] << "MadePerActiveAgent_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double) devicesMade[i][j] / (double) activeAgents[j] ) << ",";
+            file << ( (double) devicesMade.dayRow(j)[i] / (double) activeAgents.at(j) ) << ",";
         }
         file << "\n";
     }
 
     /* device made per goup */
-    vector< vector< vector <int> > > devicesMadeByGroup = glob.productionStats->getDevicesMadeByGroup();
-    vector<vector<int> > activeGroupAgents = glob.otherStats->getActiveGroupAgents();
+    const DailyHistory<int> &devicesMadeByGroup = glob.productionStats->getDevicesMadeByGroup();
+    const DailyHistory<int> &activeGroupAgents = glob.otherStats->getActiveGroupAgents();
     for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
         for (int i = 0; i < NUM_DEVICE_TYPES; i++) {
             file << devicesStr[i] << "MadeByGroup" << gId << "_" << glob.SIM_NAME << ",";
             for (int j = 0; j < glob.NUM_DAYS; j++) {
-                file << ( (double) devicesMadeByGroup[gId][i][j] / (double) activeGroupAgents[gId][j] ) << ",";
+                file << ( (double) devicesMadeByGroup.dayRow(j, gId)[i] / (double) activeGroupAgents.dayRow(j)[gId] ) << ",";
             }
             file << "\n";
         }
     }
     file << "\n";
     file.close();
-
-    activeAgents.clear();
-    activeGroupAgents.clear(); 
-    devicesMade.clear();
-    devicesMadeByGroup.clear();
 }
 
 
@@ -962,27 +877,27 @@ void Utils::saveTotalTimeUsage()
     headerByDay(file, filePath);
     file.open(filePath.c_str(), ios::app);
 
-    vector<int> activeAgents = glob.otherStats->getActiveAgents();
+    const DailyHistory<int> &activeAgents = glob.otherStats->getActiveAgents();
     string devicesStr[] = { "TOOL", "MACHINE", "FACTORY", "INDUSTRY", "DEVMACHINE", "DEVFACTORY" };
 
     /* timeSpentGatheringWithDevice per agent */
-    vector<vector<double> > timeSpentGatheringWithDevice = glob.productionStats->getTimeSpentGatheringWithDevice();
+    const DailyHistory<double> &timeSpentGatheringWithDevice = glob.productionStats->getTimeSpentGatheringWithDevice();
     for (int i = 0; i < NUM_DEVICE_TYPES - 2; i++) {
         file << devicesStr[i] << "_timeGatheringWithDevicePerActiveAgent_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double) timeSpentGatheringWithDevice[i][j] / (double) activeAgents[j] ) << ",";
+            file << ( (double) timeSpentGatheringWithDevice.dayRow(j)[i] / (double) activeAgents.at(j) ) << ",";
         }
         file << "\n";
     }
 
     /* timeSpentGatheringWithDevice per group */
-    vector< vector<vector<double> > > timeSpentGatheringWithDeviceByGroup = glob.productionStats->getTimeSpentGatheringWithDeviceByGroup();
-    vector<vector<int> > activeGroupAgents = glob.otherStats->getActiveGroupAgents();
+    const DailyHistory<double> &timeSpentGatheringWithDeviceByGroup = glob.productionStats->getTimeSpentGatheringWithDeviceByGroup();
+    const DailyHistory<int> &activeGroupAgents = glob.otherStats->getActiveGroupAgents();
     for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
         for (int i = 0; i < NUM_DEVICE_TYPES - 2; i++) {
             file << devicesStr[i] << "_timeGatheringWithDeviceByGroup " << gId << "_" << glob.SIM_NAME << ",";
             for (int j = 0; j < glob.NUM_DAYS; j++) {
-                file << ( (double) timeSpentGatheringWithDeviceByGroup[gId][i][j] / (double) activeGroupAgents[gId][j] ) << ",";
+                file << ( (double) timeSpentGatheringWithDeviceByGroup.dayRow(j, gId)[i] / (double) activeGroupAgents.dayRow(j)[gId] ) << ",";
             }
             file << "\n";
         }
@@ -990,22 +905,22 @@ void Utils::saveTotalTimeUsage()
     file << "\n";       // add an extra line so more readable.
 
     /* timeMakingDevices per agent */
-    vector< vector<double> > timeSpentMakingDevices = glob.productionStats->getTimeSpentMakingDevices();
+    const DailyHistory<double> &timeSpentMakingDevices = glob.productionStats->getTimeSpentMakingDevices();
     for (int i = 0; i < NUM_DEVICE_TYPES; i++) {
         file << devicesStr[i] << " timeMakingDevicesPerActiveAgent_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << ( (double) timeSpentMakingDevices[i][j] / (double) activeAgents[j] ) << ",";
+            file << ( (double) timeSpentMakingDevices.dayRow(j)[i] / (double) activeAgents.at(j) ) << ",";
         }
         file << "\n";
     }
 
     /* timeMakingDevices per group */
-    vector< vector<vector<double> > > timeSpentMakingDevicesByGroup = glob.productionStats->getTimeSpentMakingDevicesByGroup();
+    const DailyHistory<double> &timeSpentMakingDevicesByGroup = glob.productionStats->getTimeSpentMakingDevicesByGroup();
     for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
         for (int i = 0; i < NUM_DEVICE_TYPES; i++) {
             file << devicesStr[i] << " timeMakingDevicesByGroup " << gId << "_" << glob.SIM_NAME << ",";
             for (int j = 0; j < glob.NUM_DAYS; j++) {
-                file << ( (double) timeSpentMakingDevicesByGroup[gId][i][j] / (double) activeGroupAgents[gId][j] ) << ",";
+                file << ( (double) timeSpentMakingDevicesByGroup.dayRow(j, gId)[i] / (double) activeGroupAgents.dayRow(j)[gId] ) << ",";
             }
             file << "\n";
         }
@@ -1014,32 +929,23 @@ void Utils::saveTotalTimeUsage()
 
     /* timeGatheringWithoutDevice per agent */
     file << "timeGatheringWithoutDevicePerActiveAgent_" << glob.SIM_NAME << ",";
-    vector<double> timeSpentGatheringWithoutDevice = glob.productionStats->getTimeSpentGatheringWithoutDevice();
+    const vector<double> &timeSpentGatheringWithoutDevice = glob.productionStats->getTimeSpentGatheringWithoutDevice();
     for (int i = 0; i < glob.NUM_DAYS; i++) {
-        file << ( (double) timeSpentGatheringWithoutDevice[i] / (double) activeAgents[i] ) << ",";
+        file << ( (double) timeSpentGatheringWithoutDevice[i] / (double) activeAgents.at(i) ) << ",";
     }
     file << "\n";
 
     /* timeGatheringWithoutDevice per group */
-    vector<vector<double> > timeSpentGatheringWithoutDeviceByGroup = glob.productionStats->getTimeSpentGatheringWithoutDeviceByGroup();
+    const DailyHistory<double> &timeSpentGatheringWithoutDeviceByGroup = glob.productionStats->getTimeSpentGatheringWithoutDeviceByGroup();
     for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
         file << "timeGatheringWithoutDeviceByGroup " << gId << "_" << glob.SIM_NAME << ",";
         for (int i = 0; i < glob.NUM_DAYS; i++) {
-            file << ( (double) timeSpentGatheringWithoutDeviceByGroup[gId][i] / (double)activeGroupAgents[gId][i] ) << ",";
+            file << ( (double) timeSpentGatheringWithoutDeviceByGroup.dayRow(i)[gId] / (double)activeGroupAgents.dayRow(i)[gId] ) << ",";
         }
         file << "\n";
     }
     file << "\n\n";       // add two extra lines so more readable.
     file.close();
-
-    activeAgents.clear();
-    activeGroupAgents.clear(); 
-    timeSpentGatheringWithDevice.clear();
-    timeSpentGatheringWithDeviceByGroup.clear();
-    timeSpentMakingDevices.clear();
-    timeSpentMakingDevicesByGroup.clear();
-    timeSpentGatheringWithoutDevice.clear();
-    timeSpentGatheringWithoutDeviceByGroup.clear();
 }
 
 /**
@@ -1054,17 +960,16 @@ void Utils::saveDevicePercents()
     file.open(filePath.c_str(), ios::app);
 
     string devicesStr[] = { "TOOL", "MACHINE", "FACTORY", "INDUSTRY", "DEVMACHINE", "DEVFACTORY" };
-    vector< vector<double> > percentResGatheredByDevice = glob.productionStats->getPercentResGatheredByDevice();
+    const DailyHistory<double> &percentResGatheredByDevice = glob.productionStats->getPercentResGatheredByDevice();
     for (int i = 0; i < NUM_DEVICE_TYPES - 2; i++) {
         file << devicesStr[i] << "percentResGatheredWith_" << glob.SIM_NAME << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
-            file << percentResGatheredByDevice[i][j] << ",";
+            file << percentResGatheredByDevice.dayRow(j)[i] << ",";
         }
         file << "\n";
     }
     file << "\n";
     file.close();
-    percentResGatheredByDevice.clear();
 }
 
 /**
@@ -1082,18 +987,18 @@ void Utils::saveDevDevice()
     string devicesStr[] = { "TOOL", "MACHINE", "FACTORY", "INDUSTRY", "DEVMACHINE", "DEVFACTORY" };
 
     /* devices made with devDevice by total agents */
-    vector<vector<int> > devicesMade = glob.productionStats->getDevicesMade();
-    vector<vector<int> > devicesMadeWithDevDevice = glob.productionStats->getDevicesMadeWithDevDevice();
+    const DailyHistory<int> &devicesMade = glob.productionStats->getDevicesMade();
+    const DailyHistory<int> &devicesMadeWithDevDevice = glob.productionStats->getDevicesMadeWithDevDevice();
     for (int i = 4; i < NUM_DEVICE_TYPES; i++) {
         file << devicesStr[i] << "Use_" << glob.SIM_NAME  << ",";
         for (int j = 0; j < glob.NUM_DAYS; j++) {
             if (devicesStr[i] == "DEVMACHINE") {
-                totalMade = devicesMade[0][j];
+                totalMade = devicesMade.dayRow(j)[0];
             } else if (devicesStr[i] == "DEVFACTORY") {
-                totalMade = devicesMade[1][j];
+                totalMade = devicesMade.dayRow(j)[1];
             }
             if (totalMade > 0) {
-                file << ( (double) devicesMadeWithDevDevice[i][j] / (double) totalMade ) << ",";
+                file << ( (double) devicesMadeWithDevDevice.dayRow(j)[i] / (double) totalMade ) << ",";
             } else {
                 file << 0 << ",";
             }
@@ -1102,19 +1007,19 @@ void Utils::saveDevDevice()
     }
 
     /* devices made with devDevice by each group */
-    vector<vector<vector<int> > > devicesMadeByGroup = glob.productionStats->getDevicesMadeByGroup();
-    vector<vector<vector<int> > > devicesMadeWithDevDeviceByGroup = glob.productionStats->getDevicesMadeWithDevDeviceByGroup();
+    const DailyHistory<int> &devicesMadeByGroup = glob.productionStats->getDevicesMadeByGroup();
+    const DailyHistory<int> &devicesMadeWithDevDeviceByGroup = glob.productionStats->getDevicesMadeWithDevDeviceByGroup();
     for (int gId = 0; gId < glob.NUM_AGENT_GROUPS; gId++) {
         for (int i = 4; i < NUM_DEVICE_TYPES; i++) {
             file << "Group " << gId << "_" << devicesStr[i] << " Use_" << glob.SIM_NAME  << ",";
             for (int j = 0; j < glob.NUM_DAYS; j++) {
                 if (devicesStr[i] == "DEVMACHINE") {
-                    totalMade = devicesMadeByGroup[gId][0][j];
+                    totalMade = devicesMadeByGroup.dayRow(j, gId)[0];
                 } else if (devicesStr[i] == "DEVFACTORY") {
-                    totalMade = devicesMadeByGroup[gId][1][j];
+                    totalMade = devicesMadeByGroup.dayRow(j, gId)[1];
                 }
                 if (totalMade > 0) {
-                    file << ( (double) devicesMadeWithDevDeviceByGroup[gId][i][j] / (double) totalMade ) << ",";
+                    file << ( (double) devicesMadeWithDevDeviceByGroup.dayRow(j, gId)[i] / (double) totalMade ) << ",";
                 } else {
                     file << 0 << ",";
                 }
@@ -1124,11 +1029,6 @@ void Utils::saveDevDevice()
     }
     file << "\n";
     file.close();
-
-    devicesMade.clear();
-    devicesMadeWithDevDevice.clear();
-    devicesMadeByGroup.clear();
-    devicesMadeWithDevDeviceByGroup.clear();
 }
 
 /**
@@ -1143,19 +1043,17 @@ void Utils::saveDeviceComplexity()
     file.open(filePath.c_str(), ios::app);
 
     file << "complexity_" << glob.SIM_NAME << ",";
-    vector< vector<double> > percentResGatheredByDevice = glob.productionStats->getPercentResGatheredByDevice();
+    const DailyHistory<double> &percentResGatheredByDevice = glob.productionStats->getPercentResGatheredByDevice();
     double complexityToday;
     for (int i = 0; i < glob.NUM_DAYS; i++) {
         complexityToday = 0.0;
         for (int j = 0; j < 4; j++) {
-            complexityToday += percentResGatheredByDevice[j][i] * glob.RES_IN_DEV[j];
+            complexityToday += percentResGatheredByDevice.dayRow(i)[j] * glob.RES_IN_DEV[j];
         }
         file << complexityToday << ",";
     }
     file << "\n";
     file.close();
-
-    percentResGatheredByDevice.clear();
 }
 
 
@@ -1163,7 +1061,7 @@ void Utils::saveDeviceComplexity()
  * BRH: 10.2.2017 Save number of devices and recipes of each type made for each resource 
  */
 void Utils::saveDeviceRecipes()
-{	vector< vector< vector<int> > > devicesMadeByRes = glob.productionStats->getDevicesMadeByRes();
+{	const DailyHistory<int> &devicesMadeByRes = glob.productionStats->getDevicesMadeByRes();
 
     ofstream file;     /* Open up a generic "file" to write to */
     string filePath = glob.SIM_SAVE_FOLDER + "/DeviceRecipes.csv"; 
@@ -1177,7 +1075,7 @@ void Utils::saveDeviceRecipes()
 			file << glob.currentDay+1 << ",";
 			file << "R" << resId+1 << ",";
   		for (int type = 0; type < NUM_RESOURCE_GATHERING_DEVICES; type++) {
-			file <<  ( (int) devicesMadeByRes[type][resId][glob.currentDay]) << ",";
+			file <<  ( (int) devicesMadeByRes.dayRow(glob.currentDay, type)[resId]) << ",";
         }
    		for (int type = 0; type < NUM_RESOURCE_GATHERING_DEVICES; type++) {
 			if (glob.discoveredDevices[type][resId]) {
@@ -1193,17 +1091,16 @@ void Utils::saveDeviceRecipes()
     file << "\n";
 	}
     file.close();
-    devicesMadeByRes.clear();
 }
 
 // BRH: 10.12.2017 New routine to save Use Matrix
 //JYC: 07.31.2018
 void Utils::saveUseMatrix()
-{	vector< vector< vector<int> > > devicesMadeByRes = glob.productionStats->getDevicesMadeByRes();
-    vector< vector<int> > resGatheredByRes = glob.productionStats->getResGatheredByRes();
-    vector< vector< vector<double> > > timeSpentGatheringWithDeviceByRes = glob.productionStats->getTimeSpentGatheringWithDeviceByRes();
-    vector< vector<double> > timeSpentGatheringWithoutDeviceByRes = glob.productionStats->getTimeSpentGatheringWithoutDeviceByRes();   
-    vector< vector<vector<double> > > timeSpentMakingDevicesByDeviceByRes = glob.productionStats->getTimeSpentMakingDevicesByDeviceByRes();
+{	const DailyHistory<int> &devicesMadeByRes = glob.productionStats->getDevicesMadeByRes();
+    const DailyHistory<int> &resGatheredByRes = glob.productionStats->getResGatheredByRes();
+    const DailyHistory<double> &timeSpentGatheringWithDeviceByRes = glob.productionStats->getTimeSpentGatheringWithDeviceByRes();
+    const DailyHistory<double> &timeSpentGatheringWithoutDeviceByRes = glob.productionStats->getTimeSpentGatheringWithoutDeviceByRes();   
+    const DailyHistory<double> &timeSpentMakingDevicesByDeviceByRes = glob.productionStats->getTimeSpentMakingDevicesByDeviceByRes();
     int temp_in_device=0;
 	double num_of_that_device_made;
    
@@ -1240,7 +1137,7 @@ void Utils::saveUseMatrix()
 					for (vector<int>::iterator comp = glob.discoveredDevices[TOOL][resId]->components.begin();
 						comp < glob.discoveredDevices[TOOL][resId]->components.end(); comp++) {
 						if (product==*comp) temp_in_device=1;
-						num_of_that_device_made = (int) devicesMadeByRes[TOOL][resId][glob.currentDay];
+						num_of_that_device_made = (int) devicesMadeByRes.dayRow(glob.currentDay, TOOL)[resId];
 					} // End check to see if this current row's product is in this column's device.
 				file << "," << temp_in_device * num_of_that_device_made ;
 				} // End fill cell of discovered device.
@@ -1264,7 +1161,7 @@ void Utils::saveUseMatrix()
 		if (product != resId) {
 	        	file << "," << 0;
 	        	} else {
-				file << "," << timeSpentGatheringWithDeviceByRes[TOOL][resId][glob.currentDay];
+				file << "," << timeSpentGatheringWithDeviceByRes.dayRow(glob.currentDay, TOOL)[resId];
 	        }
 		}
 // Fill in zeros for flows of T1 devices into all T1 industries.
@@ -1277,7 +1174,7 @@ void Utils::saveUseMatrix()
 					for (vector<int>::iterator comp = glob.discoveredDevices[MACHINE][resId]->components.begin();
 						comp < glob.discoveredDevices[MACHINE][resId]->components.end(); comp++) {   
 						if (product==*comp) temp_in_device=1; 
-						num_of_that_device_made = (double) devicesMadeByRes[MACHINE][resId][glob.currentDay];
+						num_of_that_device_made = (double) devicesMadeByRes.dayRow(glob.currentDay, MACHINE)[resId];
 					} // End check to see if this current row's product is in this column's device. 
 				file << "," << temp_in_device * num_of_that_device_made * glob.TOOL_LIFETIME;
 				} // End fill cell of discovered device.
@@ -1311,7 +1208,7 @@ void Utils::saveUseMatrix()
 		if (product != resId) {
 	        	file << "," << 0;	
 	        	} else {
-				file << "," << timeSpentGatheringWithDeviceByRes[MACHINE][resId][glob.currentDay];
+				file << "," << timeSpentGatheringWithDeviceByRes.dayRow(glob.currentDay, MACHINE)[resId];
 	        }
 		}
 // Fill in zeros for flows of T2 devices into T1 and T2 industries.
@@ -1324,7 +1221,7 @@ void Utils::saveUseMatrix()
 					for (vector<int>::iterator comp = glob.discoveredDevices[FACTORY][resId]->components.begin();
 						comp < glob.discoveredDevices[FACTORY][resId]->components.end(); comp++) {   
 						if (product==*comp) temp_in_device=1; 
-						num_of_that_device_made = (double) devicesMadeByRes[FACTORY][resId][glob.currentDay];
+						num_of_that_device_made = (double) devicesMadeByRes.dayRow(glob.currentDay, FACTORY)[resId];
 					} // End check to see if this current row's product is in this column's device. 
 				file << "," << temp_in_device * num_of_that_device_made * glob.MACHINE_LIFETIME;
 				} // End fill cell of discovered device.
@@ -1355,7 +1252,7 @@ void Utils::saveUseMatrix()
 		if (product != resId) {
 	        	file << "," << 0;	
 	        	} else {
-				file << "," << timeSpentGatheringWithDeviceByRes[FACTORY][resId][glob.currentDay];
+				file << "," << timeSpentGatheringWithDeviceByRes.dayRow(glob.currentDay, FACTORY)[resId];
 	        }
 		}
 // Fill in zeros for flows of T3 devices into T1, T2 and T3 industries.
@@ -1368,7 +1265,7 @@ void Utils::saveUseMatrix()
 					for (vector<int>::iterator comp = glob.discoveredDevices[INDUSTRY][resId]->components.begin();
 						comp < glob.discoveredDevices[INDUSTRY][resId]->components.end(); comp++) {   
 						if (product==*comp) temp_in_device=1; 
-						num_of_that_device_made = (double) devicesMadeByRes[INDUSTRY][resId][glob.currentDay];
+						num_of_that_device_made = (double) devicesMadeByRes.dayRow(glob.currentDay, INDUSTRY)[resId];
 					} // End check to see if this current row's product is in this column's device. 
 				file << "," << temp_in_device * num_of_that_device_made * glob.FACTORY_LIFETIME;
 				} // End fill cell of discovered device.
@@ -1396,7 +1293,7 @@ void Utils::saveUseMatrix()
 		if (product != resId) {
 	        	file << "," << 0;
 	        	} else {
-				file << "," << timeSpentGatheringWithDeviceByRes[INDUSTRY][resId][glob.currentDay];
+				file << "," << timeSpentGatheringWithDeviceByRes.dayRow(glob.currentDay, INDUSTRY)[resId];
 	        }
 		}
 // Fill in zeros for flows of T4 devices into T1, T2, T3, and T4 industries.
@@ -1415,15 +1312,15 @@ void Utils::saveUseMatrix()
 		file << "Labor" ;
 		for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
 			double totalTimeGatheringByRes = 0;
-			totalTimeGatheringByRes += timeSpentGatheringWithoutDeviceByRes[resId][glob.currentDay];
+			totalTimeGatheringByRes += timeSpentGatheringWithoutDeviceByRes.dayRow(glob.currentDay)[resId];
 			for (int type = 0; type < glob.getNumResGatherDev(); type++) {
-    		   	totalTimeGatheringByRes += timeSpentGatheringWithDeviceByRes[type][resId][glob.currentDay];
+    		   	totalTimeGatheringByRes += timeSpentGatheringWithDeviceByRes.dayRow(glob.currentDay, type)[resId];
 			}
 		file << "," << totalTimeGatheringByRes;
 		}
 		for (int type = TOOL; type <= INDUSTRY; type++) {
 			for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-				file << "," << timeSpentMakingDevicesByDeviceByRes[type][resId][glob.currentDay];
+				file << "," << timeSpentMakingDevicesByDeviceByRes.dayRow(glob.currentDay, type)[resId];
 			}
 		}
 		file << "\n";  //Last thing to do before starting the next row.
@@ -1440,27 +1337,26 @@ void Utils::saveUseMatrix()
 		file << glob.currentDay+1 << ",";
 		file << "Total";
              for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
-                    file  << "," << resGatheredByRes[resId][glob.currentDay];
+                    file  << "," << resGatheredByRes.dayRow(glob.currentDay)[resId];
              }
              for (int resId = 0; resId < glob.NUM_RESOURCES ; resId++) {
 		            file  << ","
-                        <<  ( (int) devicesMadeByRes[TOOL][resId][glob.currentDay] * glob.TOOL_LIFETIME );
+                        <<  ( (int) devicesMadeByRes.dayRow(glob.currentDay, TOOL)[resId] * glob.TOOL_LIFETIME );
             }
              for (int resId = 0; resId < glob.NUM_RESOURCES ; resId++) {
 		            file  << ","
-                        <<  ( (int) devicesMadeByRes[MACHINE][resId][glob.currentDay] * glob.MACHINE_LIFETIME );
+                        <<  ( (int) devicesMadeByRes.dayRow(glob.currentDay, MACHINE)[resId] * glob.MACHINE_LIFETIME );
             }
              for (int resId = 0; resId < glob.NUM_RESOURCES ; resId++) {
 		            file  << ","
-                        <<  ( (int) devicesMadeByRes[FACTORY][resId][glob.currentDay] * glob.FACTORY_LIFETIME );
+                        <<  ( (int) devicesMadeByRes.dayRow(glob.currentDay, FACTORY)[resId] * glob.FACTORY_LIFETIME );
             }
              for (int resId = 0; resId < glob.NUM_RESOURCES ; resId++) {
 		            file  << ","
-                        <<  ( (int) devicesMadeByRes[INDUSTRY][resId][glob.currentDay] * glob.INDUSTRY_LIFETIME );
+                        <<  ( (int) devicesMadeByRes.dayRow(glob.currentDay, INDUSTRY)[resId] * glob.INDUSTRY_LIFETIME );
             }
  	file << "\n";
 	file.close();
-	devicesMadeByRes.clear();
 }	// END of saveUseMatrix function.
 
 //*******************************************************************
@@ -1479,11 +1375,20 @@ void Utils::saveTradeFlows()
 	file.close();
 }	//Ends saveTradeFlows
 
+/**
+ * Save the results of the run.  With the minimal stats profile only
+ * long_output is saved; the other files need stats it does not record.
+ */
 void Utils::saveResults()
-{   saveUnitsGathered();    /* BRH 05.26.2018 Save total gathered of each resource for last run, last day */
-	saveDeviceRecipes(); 	/* BRH 10.12.2017 Use this routine to print condensed recipes */
+{   bool standardStats = (glob.STATS_PROFILE >= STATS_STANDARD);
+    if (standardStats) {
+        saveUnitsGathered();    /* BRH 05.26.2018 Save total gathered of each resource for last run, last day */
+        saveDeviceRecipes(); 	/* BRH 10.12.2017 Use this routine to print condensed recipes */
+    }
 	saveOutput(); 			/* BRH 3.15.2017: this is the new routine that prints out the long_output file format. */
-    saveUseMatrix(); 		/* BRH 10.2.2017 Use this routine to create I0 tables */
+    if (standardStats) {
+        saveUseMatrix(); 		/* BRH 10.2.2017 Use this routine to create I0 tables */
+    }
 //	saveTradeFlows(); 		/* BRH 05.26.2018 commented out. 11.11.2017 Print out the daily tradeflows */
 
 /*********    Do not write out these files anymore once long_output file is fully functioning. 
@@ -1555,28 +1460,308 @@ void Utils::removeRes(int resNumber, int day)
     glob.res[resNumber].remove();
     for (unsigned int i = 0; i < glob.agent.size(); i++) {
         for (int device = 0; device < 6; device++) {
-            glob.agent[i]->devProp[device][resNumber].deviceHeld = 0;
+            glob.agent[i]->devProp[device][resNumber].setDeviceHeld(0);
         }
     }
     if (glob.ELIMINATE_RESERVES) {
         for (unsigned int i = 0; i < glob.agent.size(); i++) {
             glob.agent[i]->resProp[resNumber].setHeld(0);
-            glob.agent[i]->resProp[resNumber].experience = 0;
+            glob.agent[i]->resProp[resNumber].setExperience(0);
         }
     }
     cout << "Res " << resNumber << " has been removed on day " << day << endl;
 }
 
-/* TODO NOT IMPLEMENTED YET */
+/**
+ * The first bytes of a day status file, and the version of its layout.
+ * Change DAY_STATUS_VERSION whenever saveDayStatus() writes something new.
+ */
+static const char DAY_STATUS_MAGIC[8] = { 'S', 'O', 'C', 'D', 'A', 'Y', 'S', 'T' };
+static const uint32_t DAY_STATUS_VERSION = 4;
+
+/**
+ * \return the day status file for the config file in use, in the given folder.
+ */
+static string dayStatusPath(string folder)
+{
+    return folder + '/' + boost::filesystem::path(glob.configFilename).stem().string() + ".status";
+}
+
+/**
+ * \return a new device of the given type, as made by Agent::toolInvention()
+ * or Agent::deviceInvention().
+ */
+static Device *newDevice(device_name_t type, vector<int> &components, int use)
+{
+    switch (type) {
+    case TOOL:       return new Tool(components, use);
+    case MACHINE:    return new Machine(components, use);
+    case FACTORY:    return new Factory(components, use);
+    case INDUSTRY:   return new Industry(components, use);
+    case DEVMACHINE: return new DevMachine(components, use);
+    case DEVFACTORY: return new DevFactory(components, use);
+    default:         return NULL;
+    }
+}
+
+/**
+ * Write the state of the run at the end of the given day to out: the
+ * random number generators, the resources, the discovered devices, the
+ * agents and the stats histories, in the byte order of the machine (see
+ * binaryio.h).  readDayStatus() reads it back.
+ * \param out the stream to write to, opened in binary mode
+ * \param day the day that has just ended
+ */
+void Utils::writeDayStatus(ostream &out, int day)
+{
+    out.write(DAY_STATUS_MAGIC, sizeof(DAY_STATUS_MAGIC));
+    writeBinary(out, DAY_STATUS_VERSION);
+    writeBinary(out, day);
+    writeBinary(out, glob.NUM_AGENTS);
+    writeBinary(out, glob.NUM_RESOURCES);
+    writeBinary(out, glob.NUM_AGENT_GROUPS);
+
+    glob.saveRandomState(out);
+
+    for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+        writeBinary(out, glob.res[resId].inSimulation);
+    }
+    /*
+     * The devices only need their components to be made again.  The
+     * device types are in the order in which the components of each type
+     * are discovered, so they can be made again in this order.
+     */
+    for (int type = TOOL; type < NUM_DEVICE_TYPES; type++) {
+        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+            Device *device = glob.discoveredDevices[type][resId];
+            writeBinary(out, device != NULL);
+            if (device != NULL) {
+                writeBinary(out, device->components);
+            }
+        }
+    }
+
+    writeBinary(out, glob.activeAgents);
+    writeBinary(out, glob.NUM_AGENTS_IN_GROUP);
+    writeBinary(out, glob.NUM_ACTIVE_AGENTS_IN_GROUP);
+    BOOST_FOREACH(Agent *agent, glob.agent) {
+        writeBinary(out, agent->personalValues);
+        agent->saveState(out);
+    }
+
+    glob.tradeStats->saveState(out);
+    glob.productionStats->saveState(out);
+    glob.otherStats->saveState(out);
+    out.write(DAY_STATUS_MAGIC, sizeof(DAY_STATUS_MAGIC));
+}
+
+/**
+ * Read a day status written by writeDayStatus().  glob.res,
+ * glob.discoveredDevices and glob.agent must be empty, and the stats
+ * freshly made by setGlobalStats(); they are filled in from the status.
+ * \param in the stream to read from, opened in binary mode
+ * \param day the day the status must have been saved on
+ * \param source where the status comes from, for the error messages
+ * \return false (after printing why) if the status is truncated or was
+ * saved for another day or another population.
+ */
+bool Utils::readDayStatus(istream &in, int day, string source)
+{
+    char magic[sizeof(DAY_STATUS_MAGIC)];
+    uint32_t version = 0;
+    in.read(magic, sizeof(magic));
+    readBinary(in, version);
+    if (! in || ! equal(magic, magic + sizeof(magic), DAY_STATUS_MAGIC)) {
+        cerr << source << " is not a day status" << endl;
+        return false;
+    }
+    if (version != DAY_STATUS_VERSION) {
+        cerr << source << " has version " << version << ", this program reads version " <<
+            DAY_STATUS_VERSION << endl;
+        return false;
+    }
+    int savedDay, numAgents, numResources, numAgentGroups;
+    readBinary(in, savedDay);
+    readBinary(in, numAgents);
+    readBinary(in, numResources);
+    readBinary(in, numAgentGroups);
+    if (savedDay != day) {
+        cerr << source << " was saved on day " << savedDay << ", so START_DAY must be " << savedDay + 1 << endl;
+        return false;
+    }
+    if (numAgents != glob.NUM_AGENTS || numResources != glob.NUM_RESOURCES ||
+        numAgentGroups != glob.NUM_AGENT_GROUPS) {
+        cerr << source << " was saved with " << numAgents << " agents, " << numResources <<
+            " resources and " << numAgentGroups << " agent groups" << endl;
+        return false;
+    }
+
+    glob.loadRandomState(in);
+
+    for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+        glob.res.push_back(Resource(resId));
+        readBinary(in, glob.res[resId].inSimulation);
+    }
+    for (int type = TOOL; type < NUM_DEVICE_TYPES; type++) {
+        for (int resId = 0; resId < glob.NUM_RESOURCES; resId++) {
+            bool exists = false;
+            readBinary(in, exists);
+            glob.discoveredDevices[type].push_back(NULL);
+            if (exists) {
+                vector<int> components;
+                readBinary(in, components);
+                glob.discoveredDevices[type][resId] = newDevice((device_name_t) type, components, resId);
+            }
+        }
+    }
+
+    readBinary(in, glob.activeAgents);
+    readBinary(in, glob.NUM_AGENTS_IN_GROUP);
+    readBinary(in, glob.NUM_ACTIVE_AGENTS_IN_GROUP);
+    for (int aId = 0; aId < glob.NUM_AGENTS && in; aId++) {
+        vector<vector<double> > agentValues;
+        readBinary(in, agentValues);
+        glob.agent.push_back(new Agent(aId, agentValues));
+        glob.agent[aId]->loadState(in);
+    }
+
+    glob.tradeStats->loadState(in);
+    glob.productionStats->loadState(in);
+    glob.otherStats->loadState(in);
+    in.read(magic, sizeof(magic));
+    if (! in || ! equal(magic, magic + sizeof(magic), DAY_STATUS_MAGIC)) {
+        cerr << source << " is truncated or damaged" << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Save everything needed to go on with the run after the given day in
+ * DAY_STATUS_SAVE_FOLDER: a day status file (see dayStatusPath() and
+ * writeDayStatus()) and a copy of the config file with START_DAY set to
+ * the next day.  Running with that copy of the config file restarts the
+ * run from the saved status and gives the same results as the run that
+ * saved it.
+ * \param day the day that has just ended
+ */
 void Utils::saveDayStatus(int day)
 {
-    cout << "saveDayStatus: NOT IMPLEMENTED YET!" << endl;
+    string statusPath = dayStatusPath(glob.DAY_STATUS_SAVE_FOLDER);
+    ofstream out(statusPath.c_str(), ios::out | ios::binary | ios::trunc);
+    if (! out) {
+        cerr << "Could not open " << statusPath << " to save the day status" << endl;
+        return;
+    }
+    writeDayStatus(out, day);
+    out.close();
+    if (! out) {
+        cerr << "Could not write the day status to " << statusPath << endl;
+        return;
+    }
+
+    /* The config file to restart from, with START_DAY set to the next day. */
+    string configPath = glob.DAY_STATUS_SAVE_FOLDER + '/' +
+        boost::filesystem::path(glob.configFilename).filename().string();
+    ifstream configIn(glob.configFilename.c_str());
+    ofstream configOut(configPath.c_str());
+    string line;
+    while (getline(configIn, line)) {
+        if (line.compare(0, 9, "START_DAY") == 0) {
+            bool crlf = (! line.empty() && line[line.size() - 1] == '\r');
+            line = "START_DAY = " + boost::lexical_cast<string>(day + 1) + (crlf ? "\r" : "");
+        }
+        configOut << line << '\n';
+    }
+    LOG(1) << "Day status of day " << day << " saved in " << statusPath;
 }
 
-/* TODO NOT IMPLEMENTED YET */
-void Utils::loadDayStatus()
+/**
+ * Load the day status saved by saveDayStatus() on day START_DAY - 1 from
+ * DAY_STATUS_LOAD_FOLDER, the folder of the config file.  This sets up
+ * glob.res, glob.discoveredDevices, glob.agent, the stats and the random
+ * number generators in place of perRunInitialization()'s usual setup.
+ * \return false (after printing why) if the file is missing or cannot be
+ * used, see readDayStatus().
+ */
+bool Utils::loadDayStatus()
 {
-    cout << "loadDayStatus: NOT IMPLEMENTED YET!" << endl;
+    string statusPath = dayStatusPath(glob.DAY_STATUS_LOAD_FOLDER);
+    ifstream in(statusPath.c_str(), ios::in | ios::binary);
+    if (! in) {
+        cerr << "Could not open the day status " << statusPath << endl;
+        return false;
+    }
+    if (! readDayStatus(in, glob.START_DAY - 1, statusPath)) {
+        return false;
+    }
+    LOG(1) << "Day status of day " << glob.START_DAY - 1 << " loaded from " << statusPath;
+    return true;
+}
+
+/**
+ * Append text to the open long_output file, with the header first if the
+ * file is still empty.  The file of a sweep is shared with the other runs
+ * of the sweep, which may be appending to it at the same time from other
+ * processes (see --run-jobs), so it is locked while the text, and the
+ * header if the file is new, are written.
+ * \param header the first line(s) of a new file
+ * \param text the text to append
+ */
+void Utils::appendOutput(const string &header, string text)
+{
+    if (outputFd < 0) {
+        return;
+    }
+    if (outputShared) {
+        flock(outputFd, LOCK_EX);
+    }
+    struct stat fileStat;
+    if (fstat(outputFd, &fileStat) == 0 && fileStat.st_size == 0) {
+        text = header + text;
+    }
+    const char *data = text.data();
+    size_t left = text.size();
+    while (left > 0) {
+        ssize_t written = write(outputFd, data, left);
+        if (written <= 0) {
+            cerr << "Could not write to " << outputFile << endl;
+            break;
+        }
+        data += written;
+        left -= written;
+    }
+    if (outputShared) {
+        flock(outputFd, LOCK_UN);
+    }
+}
+
+/**
+ * \return the columns of long_output: UniqueKey, Config, Run, TimeStep,
+ * then the values of the day (see calcOutputRow()).
+ */
+static vector<ColumnSpec> outputColumns()
+{
+    const char *names[] = { "avgUtil", "avgGathered", "avgHeld", "gini", "complexity", "T1_made",
+                            "T2_made", "T3_made", "T4_made", "T5_made", "T6_made", "totalUtil" };
+    vector<ColumnSpec> specs;
+    ColumnSpec spec;
+    spec.type = STRING_COLUMN;
+    spec.name = "UniqueKey";
+    specs.push_back(spec);
+    spec.name = "Config";
+    specs.push_back(spec);
+    spec.name = "Run";
+    specs.push_back(spec);
+    spec.type = INT_COLUMN;
+    spec.name = "TimeStep";
+    specs.push_back(spec);
+    spec.type = DOUBLE_COLUMN;
+    for (unsigned j = 0; j < sizeof(names) / sizeof(names[0]); j++) {
+        spec.name = names[j];
+        specs.push_back(spec);
+    }
+    return specs;
 }
 
 // BRH: 3.18.2017 New Print routine to print all output to one file in long form 
@@ -1586,97 +1771,227 @@ void Utils::loadDayStatus()
 // 2. Get process correct for each variable 
 // 3. Create subroutines to calculate and print one variable (set) to the same file                      
 //    
-void Utils::saveOutput()
+/**
+ * Calculate the long_output values of the given day: the averages, gini,
+ * complexity and devices made that day.  The gini is NaN on the first and
+ * last days.  The stats of a day are only kept while its row and the rows
+ * of the OUTPUT_WINDOW_DAYS - 1 days before it are still to be written
+ * (see stats_profile_t), so a run that saves a day status or starts
+ * branches keeps the values of the rows it writes, to write them again for
+ * the runs that go on from it (see OtherStats::addOutputRow()).
+ * \param i the day of the row
+ * \param lastDay the last day with stats so far; the gini of day i takes
+ *        days i to i + 2, or those up to lastDay at the end of the run
+ * \param values set to the values, in the order of outputColumns()
+ */
+void Utils::calcOutputRow(int i, int lastDay, vector<double> &values)
 {
-    ofstream file;     /* Open up a generic "file" to write to */
-    string filePath = glob.SIM_SAVE_FOLDER +  "/long_output.csv"; 
-// Check if this is the first run of the batch. If so, save unique key and config files.
-    firstRunCheck(file, filePath);
-
-// HEADER: Print first row of output file containing all of the variable names.
-    if ( !boost::filesystem::exists(filePath)) {
-	    file.open(filePath.c_str());
-	        file << "UniqueKey,Config,Run,TimeStep,";
-	        file << "avgUtil,avgGathered,avgHeld,gini,complexity,T1_made,";
-            file << "T2_made,T3_made,T4_made,T5_made,T6_made,totalUtil";
-	        file << "\n";
-	    file.close();
+    const DailyHistory<double> &outputRows = glob.otherStats->getOutputRows();
+    if (i < outputRows.numDays()) {
+        values.assign(outputRows.dayRow(i), outputRows.dayRow(i) + outputRows.numRows());
+        return;
     }
-//Get information to be written to output file.
-    vector<int> activeAgents = glob.otherStats->getActiveAgents();
-    vector<double> sumUtil = glob.otherStats->getSumUtil();   
-	vector<int> sumRes = glob.otherStats->getSumRes();
-	vector<int> resGath = glob.productionStats->getResGathered();
+    const DailyHistory<int> &activeAgents = glob.otherStats->getActiveAgents();
+    const DailyHistory<double> &sumUtil = glob.otherStats->getSumUtil();
+    const DailyHistory<int> &sumRes = glob.otherStats->getSumRes();
+    const DailyHistory<int> &resGath = glob.productionStats->getResGathered();
+    const DailyHistory<double> &sumUtilByAgent = glob.otherStats->getSumUtilByAgent();   // For Gini calcuation.
     vector<double> orderedUtils;  // For Gini calcuation.
-    vector<double> y; // For Gini calcuation.
-    vector<vector<double> > sumUtilByAgent = glob.otherStats->getSumUtilByAgent();   // For Gini calcuation.
 
-// ROWS: print output variables one row = one run + one day */	
-	file.open(filePath.c_str(), ios::app);   /*open that particular file in append mode */
-    for (int i = 0; i < glob.NUM_DAYS; i++) {
-		/* ORDER: UniqueKey, Config, Run (SIMNAME for now), Day, ... */
-			file << glob.UniqueKey << ",";
-			file << glob.configName << "," ;
-			file << glob.SIM_NAME << "," ;
-			file << (i + 1) << "," ; //day starts on "0" in the program, but we want it to start at "1" in output file
-			
+    values.clear();
 	/* Average Utility */;
-			file << (sumUtil[i] / activeAgents[i]) << "," ; 
+			values.push_back(sumUtil.at(i) / activeAgents.at(i)); 
 			
 	/* Average Units Held */;
-			file << ( (double) sumRes[i] / (double) activeAgents[i] ) << ",";
+			values.push_back( (double) sumRes.at(i) / (double) activeAgents.at(i) );
 	
 	/* Average Units Gathered */;
-			file << ( (double) resGath[i] / (double) activeAgents[i] ) << ",";
+			values.push_back( (double) resGath.at(i) / (double) activeAgents.at(i) );
 	
 	 /* Gini */;   
 		int dayNum = i + 1; 
 		if (dayNum == 1 || dayNum==glob.NUM_DAYS) {    	 /* Note: Leave Gini missing for first and last days. */; 
-			file << ".,";
+			values.push_back(NAN);
 		} else {
-		orderedUtils.clear();
+		int windowEnd = min(dayNum + 2, lastDay + 1);
+        // takes a three-day sum (the day and the two after) of utility to calculate Gini coefficient
+        vector<double> utility(glob.NUM_AGENTS, 0.0);
+        for (int day = dayNum - 1; day < windowEnd; day++) {
+            const double *utilityByAgent = sumUtilByAgent.dayRow(day);
+            for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {
+                utility[aId] += utilityByAgent[aId];
+            }
+        }
         for (int aId = 0; aId < glob.NUM_AGENTS; aId++) {//for every agent
             if (glob.agent[aId]->inSimulation) {
-                // takes a four-day average (one before, two after) of utility to calculate Gini coefficient
-                orderedUtils.push_back(accumulate(sumUtilByAgent[aId].begin() + dayNum - 1,
-                                                sumUtilByAgent[aId].begin() + dayNum + 2, 0.0));// create vector of utilities per agent
+                orderedUtils.push_back(utility[aId]);// create vector of utilities per agent
             }
         }
-        sort(orderedUtils.begin(), orderedUtils.end());//orders utilities smallest to largest
-        y.clear();
-        for (unsigned int i = 0; i < orderedUtils.size(); i++) {
-            y.push_back(accumulate(orderedUtils.begin(), orderedUtils.begin() + i + 1, 0));// seems to be sum of utilities up to a point, cumulative histogram type thing.
-        }
-        double B = accumulate(y.begin(), y.end(), 0.0) / (y[y.size()-1] * double(orderedUtils.size())); // arbitrary variable used in final calc.
-        file << (1.0 + (1.0 / double(orderedUtils.size())) - (2.0 * B)) << ",";// final calculation. 
+        values.push_back(gini(orderedUtils));
 		}
 		
 	/* Complexity */;
-	    vector< vector<double> > percentResGatheredByDevice = glob.productionStats->getPercentResGatheredByDevice();
+	    const DailyHistory<double> &percentResGatheredByDevice = glob.productionStats->getPercentResGatheredByDevice();
 		double complexityToday;
 		complexityToday = 0.0;
         for (int j = 0; j < 4; j++) {
-            complexityToday += percentResGatheredByDevice[j][i] * glob.RES_IN_DEV[j];
+            complexityToday += percentResGatheredByDevice.dayRow(i)[j] * glob.RES_IN_DEV[j];
         }
-        file << complexityToday << ",";
+        values.push_back(complexityToday);
 	
 	/* Devices Made */;
-		string devicesStr[] = { "TOOL(T1)", "MACHINE(T2)", "FACTORY(T3)", "INDUSTRY(T4)", "DEVMACHINE(T5)", "DEVFACTORY(T6)" };
-		vector< vector<int> > devicesMade = glob.productionStats->getDevicesMade();
+		const DailyHistory<int> &devicesMade = glob.productionStats->getDevicesMade();
 		for (int j = 0; j < NUM_DEVICE_TYPES; j++) {
-			file << ( (double) devicesMade[j][i] / (double) activeAgents[i] ) << ",";
+			values.push_back( (double) devicesMade.dayRow(i)[j] / (double) activeAgents.at(i) );
 		}
 		
 	/* Total Utility */;
-		file << sumUtil[i];
-		
+		values.push_back(sumUtil.at(i));
+
+    if ((glob.SAVE_DAY_STATUS || ! glob.BRANCHES.empty()) && i == outputRows.numDays()) {
+        glob.otherStats->addOutputRow(values);
+    }
+}
+
+/**
+ * Write the long_output row of the given day as CSV; the missing gini is '.'.
+ * \param rows where the row is written
+ * \param i the day of the row
+ * \param lastDay the last day with stats so far (see calcOutputRow())
+ */
+void Utils::writeOutputRow(ostream &rows, int i, int lastDay)
+{
+    vector<double> values;
+    calcOutputRow(i, lastDay, values);
+
+		/* ORDER: UniqueKey, Config, Run (SIMNAME for now), Day, ... */
+			rows << glob.UniqueKey << ",";
+			rows << glob.configName << "," ;
+			rows << glob.SIM_NAME << "," ;
+			rows << (i + 1); //day starts on "0" in the program, but we want it to start at "1" in output file
+    for (unsigned j = 0; j < values.size(); j++) {
+        if (std::isnan(values[j])) {
+            rows << ",.";
+        } else {
+            rows << "," << values[j];
+        }
+    }
 	/* End of Print line */;		
-		file <<"\n";  
+		rows <<"\n";  
+}
+
+/**
+ * Add the long_output row of the given day to a chunk of a column file.
+ * \param chunk the chunk, with the columns of outputColumns()
+ * \param i the day of the row
+ * \param lastDay the last day with stats so far (see calcOutputRow())
+ */
+void Utils::addOutputRow(ColumnChunk &chunk, int i, int lastDay)
+{
+    vector<double> values;
+    calcOutputRow(i, lastDay, values);
+    chunk.addString(0, glob.UniqueKey);
+    chunk.addString(1, glob.configName);
+    chunk.addString(2, glob.SIM_NAME);
+    chunk.addInt(3, i + 1);
+    for (unsigned j = 0; j < values.size(); j++) {
+        chunk.addDouble(4 + j, values[j]);
+    }
+    chunk.endRow();
+}
+
+/**
+ * Append the long_output rows that are complete once day lastDay is over
+ * (the gini of a day needs the two days after it), so the rows are written
+ * as the run goes and survive a run that is killed.  Called from
+ * dayAnalysis() each day and from saveOutput() at the end of the run.
+ * A run that starts from a day status, or a branch that starts saving in
+ * its own folder, first writes the rows of the days before it.
+ * With BINARY_OUTPUT the rows go to long_output.socb (see columnfile.h)
+ * instead of long_output.csv.  The file is opened on the first call of a
+ * run and stays open until the end of the run.
+ * \param lastDay the last day with stats so far
+ * \param endOfRun true to write all the rows left
+ */
+void Utils::streamOutput(int lastDay, bool endOfRun)
+{
+    string fileName = glob.BINARY_OUTPUT ? "/long_output.socb" : "/long_output.csv";
+    string filePath = glob.SIM_SAVE_FOLDER + fileName;
+    if (glob.SWEEP_FOLDER != "") {
+        // one file for all the runs of a sweep; see main() for the unique key and config files
+        filePath = glob.SWEEP_FOLDER + fileName;
+    }
+    // the runs of a sweep share the file, so a new run is told by its key and name too
+    string outputRun = filePath + ',' + glob.UniqueKey + ',' + glob.SIM_NAME;
+    if (outputRun != outputPath) {
+        outputPath = outputRun;
+        outputNextDay = 0;
+        if (glob.SWEEP_FOLDER == "") {
+            // Check if this is the first run of the batch. If so, save unique key and config files.
+            ofstream file;
+            firstRunCheck(file, filePath);
+        }
+        if (outputFd >= 0) {
+            close(outputFd);    // left open by a run that did not end, such as the run a branch forked from
+        }
+        outputFile = filePath;
+        outputShared = (glob.SWEEP_FOLDER != "");
+        outputFd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0666);
+        if (outputFd < 0) {
+            cerr << "Could not open " << filePath << endl;
+        }
     }
-file.close();
 
-    sumUtil.clear();
-    activeAgents.clear();
+    static const vector<ColumnSpec> columns = outputColumns();
+    int lastRow = endOfRun ? lastDay : lastDay - 2;
+    if (outputNextDay <= lastRow) {
+        writeOutputRows(columns, lastRow, lastDay);
+    }
+    if (endOfRun && outputFd >= 0) {
+        close(outputFd);
+        outputFd = -1;
+    }
+}
+
+/**
+ * Append the long_output rows from outputNextDay to lastRow to the open
+ * long_output file (see streamOutput()).
+ * \param columns the columns of the rows
+ * \param lastRow the day of the last row to write
+ * \param lastDay the last day with stats so far (see calcOutputRow())
+ */
+void Utils::writeOutputRows(const vector<ColumnSpec> &columns, int lastRow, int lastDay)
+{
+    if (glob.BINARY_OUTPUT) {
+        ColumnChunk chunk(columns);
+        for (; outputNextDay <= lastRow; outputNextDay++) {
+            addOutputRow(chunk, outputNextDay, lastDay);
+        }
+        appendOutput(ColumnChunk::header(columns), chunk.serialize());
+        return;
+    }
+
+// HEADER: first row of output file containing all of the variable names.
+    string header;
+    for (unsigned j = 0; j < columns.size(); j++) {
+        header += (j == 0 ? "" : ",") + columns[j].name;
+    }
+    header += "\n";
+
+// ROWS: print output variables one row = one run + one day */	
+    ostringstream rows;   /* the rows of the day are appended to the file all at once */
+    for (; outputNextDay <= lastRow; outputNextDay++) {
+        writeOutputRow(rows, outputNextDay, lastDay);
+    }
+    appendOutput(header, rows.str());
+}
+
+/**
+ * Write the long_output rows not written yet by streamOutput().
+ */
+void Utils::saveOutput()
+{
+    streamOutput(glob.NUM_DAYS - 1, true);
 }
 
 
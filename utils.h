@@ -7,8 +7,22 @@
 
 #include "globals.h"
 
+class ColumnChunk;
+struct ColumnSpec;
+
 class Utils {
+private:
+    string outputPath;      // the long_output file, UniqueKey and run streamOutput() is writing
+    int outputNextDay;      // the day of the next row of outputPath
+    string outputFile;      // the long_output file open on outputFd
+    int outputFd;           // the open long_output file, or -1
+    bool outputShared;      // the file is shared by the runs of a sweep
+
+    void writeOutputRows(const vector<ColumnSpec> &columns, int lastRow, int lastDay);
+    void appendOutput(const string &header, string text);
+
 public:
+    Utils() : outputNextDay(0), outputFd(-1), outputShared(false) {}
 	void printStartConditions();
 	void agentsWork();
 	void agentsTrade();
@@ -23,8 +37,9 @@ public:
 	void removeOrSave(int dayNumber);
 	void endSim();
 	void headerByDay(ofstream &file, string filePath);
-	vector<vector<double> > calcQuartiles(vector<vector<double> > data);
+	vector<vector<double> > calcQuartiles(const vector<vector<double> > &data);
 	void firstRunCheck(ofstream &file, string filePath);
+	void saveBatchInfo();
 	void saveResults();
 	void saveGini();
 	void saveHHIQuartiles();
@@ -42,14 +57,20 @@ public:
 	void saveTradeFlows();
 	void saveDeviceRecipes();
 	void saveUniqueKey();
+	void calcOutputRow(int i, int lastDay, vector<double> &values);
+	void writeOutputRow(ostream &rows, int i, int lastDay);
+	void addOutputRow(ColumnChunk &chunk, int i, int lastDay);
+	void streamOutput(int lastDay, bool endOfRun);
 	void saveOutput();
 	void saveEndDayData();
 
      void removeAgent(int agentNumber, int day);
      void removeRes(int resNumber, int day);
 
-	void saveDayStatus(int day);		// NOT IMPLEMENtED YET.
-	void loadDayStatus();		// NOT IMPLEMENtED YET.
+	void writeDayStatus(ostream &out, int day);
+	bool readDayStatus(istream &in, int day, string source);
+	void saveDayStatus(int day);
+	bool loadDayStatus();
 };
 
 extern Utils util;